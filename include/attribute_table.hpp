@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "attribute_validator.hpp"
+#include "table_image.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace bios_config
+{
+
+/** @class AttributeIndex
+ *
+ *  @brief Flat open-addressing hash from attribute name to attribute ID.
+ *
+ *  The ID of an attribute is its position in the table image, so IDs are
+ *  dense and follow the name order. The slots hold a part of the hash and
+ *  the ID only, names are compared against the image strings when the
+ *  hashes match.
+ */
+class AttributeIndex
+{
+  public:
+    /** @brief Index the attributes of an image.
+     *
+     *  @param[in] image - the image, it must outlive the index
+     */
+    explicit AttributeIndex(const TableImage& image);
+
+    /** @brief Follow an update of the image. Only the slots of added and
+     *         removed attributes are touched, plus the IDs of the others if
+     *         they moved.
+     *
+     *  @param[in] image - the updated image, it must outlive the index
+     *  @param[in] previous - the image the index was built for
+     *  @param[in] patch - how the update mapped the IDs
+     *  @param[in] renumbered - new ID of each attribute of previous, noId
+     *                          for a removed one, only filled if
+     *                          patch.renumbered
+     */
+    void update(const TableImage& image, const TableImage& previous,
+                const TableImage::Patch& patch,
+                const std::vector<uint32_t>& renumbered);
+
+    /** @brief Look up the ID of an attribute.
+     *
+     *  @param[in] name - attribute name
+     *
+     *  @return The ID, or std::nullopt if the table does not have it.
+     */
+    std::optional<uint32_t> find(std::string_view name) const;
+
+    /** @brief Name of an attribute, referring into the image */
+    std::string_view name(uint32_t id) const
+    {
+        return image->attribute(id).name();
+    }
+
+  private:
+    static constexpr uint32_t emptySlot = TableImage::noId;
+
+    struct Slot
+    {
+        uint32_t hash = 0;
+        uint32_t id = emptySlot;
+    };
+
+    /** @brief Index every attribute of the image from scratch */
+    void build();
+    void insert(uint32_t id);
+    /** @brief Remove the slot of an attribute of the image the slots were
+     *         built for.
+     */
+    void erase(std::string_view name, uint32_t id);
+
+    const TableImage* image;
+    std::vector<Slot> slots;
+};
+
+/** @class MenuTree
+ *
+ *  @brief The menus of the attributes, built from their menu paths. A menu
+ *         path is split at '/', empty and "." components are skipped, so
+ *         "./Advanced/Memory" and "Advanced/Memory/" name the same menu and
+ *         "" or "/" the root.
+ */
+class MenuTree
+{
+  public:
+    struct Node
+    {
+        /** @brief Submenus by name, in name order */
+        std::map<std::string, uint32_t, std::less<>> children;
+        /** @brief IDs of the attributes directly in the menu, in name
+         *         order
+         */
+        std::vector<uint32_t> attributes;
+        /** @brief Number of attributes in or below the menu */
+        uint32_t count = 0;
+    };
+
+    /** @brief Build the menus of the attributes of an image.
+     *
+     *  @param[in] image - the image
+     */
+    explicit MenuTree(const TableImage& image);
+
+    /** @brief Follow an update of the image. Only the added, removed and
+     *         moved attributes are placed, the others keep their menu.
+     *
+     *  @param[in] image - the updated image
+     *  @param[in] previous - the image the tree was built for
+     *  @param[in] patch - how the update mapped the IDs
+     *  @param[in] renumbered - new ID of each attribute of previous, noId
+     *                          for a removed one, only filled if
+     *                          patch.renumbered
+     */
+    void update(const TableImage& image, const TableImage& previous,
+                const TableImage::Patch& patch,
+                const std::vector<uint32_t>& renumbered);
+
+    /** @brief Look up a menu.
+     *
+     *  @param[in] path - menu path
+     *
+     *  @return The menu, or nullptr if no attribute is in or below it.
+     */
+    const Node* find(std::string_view path) const;
+
+  private:
+    void add(std::string_view path, uint32_t id);
+    /** @brief Take an attribute out of its menu, and the menus it leaves
+     *         empty out of their parents.
+     */
+    void remove(std::string_view path, uint32_t id);
+
+    /** @brief The root is the first node. A menu left empty by an update
+     *         keeps its node, unlinked from its parent.
+     */
+    std::vector<Node> nodes;
+};
+
+/** @class AttributeTable
+ *
+ *  @brief The BaseBIOSTable image with the name index and the compiled
+ *         validators of its attributes, all addressed by attribute ID.
+ *         Replaced as a whole when a new table is set, patched by update()
+ *         when a delta is applied.
+ */
+class AttributeTable
+{
+  public:
+    /** @brief Index an image and compile its validators.
+     *
+     *  @param[in] image - the BaseBIOSTable image, kept alive by the table
+     *  @param[in] strict - throw on a malformed attribute instead of
+     *                      rejecting every value of it
+     *
+     *  @return Throws std::invalid_argument, naming the attribute, if strict
+     *          and an attribute has malformed options.
+     */
+    AttributeTable(std::shared_ptr<const TableImage> image, bool strict);
+
+    /** @brief Apply a BaseBIOSTable delta. The image is patched with
+     *         TableImage::update(), the index and the menus follow the
+     *         changed attributes and only their validators are compiled.
+     *
+     *  @param[in] upserts - attributes to add or replace
+     *  @param[in] removals - names of attributes to remove
+     *  @param[in] strict - like the constructor
+     *
+     *  @return Throws like the constructor and TableImage::update(), the
+     *          table is left as it was then.
+     */
+    void update(const TableImage::BaseTable& upserts,
+                const std::vector<std::string>& removals, bool strict);
+
+    std::optional<uint32_t> find(std::string_view name) const
+    {
+        return index.find(name);
+    }
+
+    std::string_view name(uint32_t id) const
+    {
+        return index.name(id);
+    }
+
+    TableImage::Attribute attribute(uint32_t id) const
+    {
+        return table->attribute(id);
+    }
+
+    const AttributeValidator& validator(uint32_t id) const
+    {
+        return validators[id];
+    }
+
+    const MenuTree& menus() const
+    {
+        return menuTree;
+    }
+
+    const std::shared_ptr<const TableImage>& image() const
+    {
+        return table;
+    }
+
+  private:
+    static AttributeValidator compile(const TableImage::Attribute& attr,
+                                      bool strict);
+
+    std::shared_ptr<const TableImage> table;
+    AttributeIndex index;
+    MenuTree menuTree;
+    std::vector<AttributeValidator> validators;
+};
+
+/** @class PendingStore
+ *
+ *  @brief Pending attribute values keyed by attribute ID. The D-Bus map is
+ *         only built when the PendingAttributes property is read.
+ */
+class PendingStore
+{
+  public:
+    using PendingAttribute =
+        std::tuple<TableImage::AttributeType,
+                   std::variant<int64_t, std::string>>;
+    using PendingAttributes = std::map<std::string, PendingAttribute>;
+
+    /** @brief Replace the values with loaded ones. Names the table does not
+     *         have are kept as they are, they were persisted for an earlier
+     *         table.
+     *
+     *  @param[in] table - the current table
+     *  @param[in] values - the loaded values
+     */
+    void assign(const AttributeTable& table, const PendingAttributes& values);
+
+    /** @brief Look up the pending value of an attribute.
+     *
+     *  @param[in] id - attribute ID
+     *
+     *  @return The value, or nullptr if the attribute has none.
+     */
+    const PendingAttribute* find(uint32_t id) const;
+
+    /** @brief Set the pending value of an attribute.
+     *
+     *  @param[in] id - attribute ID
+     *  @param[in] value - the value
+     *
+     *  @return bool - false if the attribute already had that value.
+     */
+    bool set(uint32_t id, const PendingAttribute& value);
+
+    void clear();
+
+    bool empty() const
+    {
+        return values.empty() && unindexed.empty();
+    }
+
+    size_t size() const
+    {
+        return values.size() + unindexed.size();
+    }
+
+    /** @brief IDs of the attributes with a pending value, in name order */
+    std::vector<uint32_t> ids() const;
+
+    /** @brief Build the PendingAttributes property.
+     *
+     *  @param[in] table - the table the IDs refer to
+     */
+    PendingAttributes attributes(const AttributeTable& table) const;
+
+  private:
+    /** @brief Ordered by ID, which is the name order */
+    std::map<uint32_t, PendingAttribute> values;
+    PendingAttributes unindexed;
+};
+
+} // namespace bios_config
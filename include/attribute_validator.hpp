@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "table_image.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <variant>
+
+namespace bios_config
+{
+
+/** @class AttributeValidator
+ *
+ *  @brief The bound options of one attribute, resolved once when the
+ *         BaseBIOSTable is set or loaded, so a pending value is checked
+ *         without scanning or decoding the options again.
+ */
+class AttributeValidator
+{
+  public:
+    using AttributeType = TableImage::AttributeType;
+    using Value = std::variant<int64_t, std::string>;
+
+    /** @brief Resolve the options of an attribute.
+     *
+     *  @param[in] attr - the attribute, the validator keeps a copy of what
+     *                    it needs, so it can be carried over to an updated
+     *                    image
+     *
+     *  @return The validator. Throws std::invalid_argument if an option has
+     *          a value of the wrong type for its bound, or a negative string
+     *          length.
+     */
+    static AttributeValidator compile(const TableImage::Attribute& attr);
+
+    /** @brief A validator that rejects every value, for an attribute whose
+     *         options could not be resolved.
+     *
+     *  @param[in] type - type of the attribute
+     */
+    static AttributeValidator rejectAll(AttributeType type);
+
+    AttributeType type() const
+    {
+        return attrType;
+    }
+
+    /** @brief Check a pending value against the options.
+     *
+     *  @param[in] value - the pending value
+     *
+     *  @return bool - true if the value is allowed.
+     */
+    bool validate(const Value& value) const;
+
+  private:
+    explicit AttributeValidator(AttributeType type) : attrType(type) {}
+
+    AttributeType attrType;
+    bool malformed = false;
+    /** @brief OneOf values of an enumeration */
+    std::unordered_set<std::string> oneOf;
+    size_t minStringLength = 0;
+    size_t maxStringLength = 0;
+    int64_t lowerBound = 0;
+    int64_t upperBound = 0;
+    int64_t scalarIncrement = 0;
+};
+
+} // namespace bios_config
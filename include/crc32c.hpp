@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace bios_config
+{
+
+/** @brief Compute the CRC32C (Castagnoli) checksum of a buffer.
+ *
+ *  @param[in] data - buffer to checksum
+ *  @param[in] crc - running checksum to continue from, 0 for a new buffer
+ *
+ *  @return The CRC32C of the buffer.
+ */
+uint32_t crc32c(std::string_view data, uint32_t crc = 0);
+
+} // namespace bios_config
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace bios_config
+{
+
+/** @class EventLimiter
+ *
+ *  @brief Rate limit of the Redfish events of one property of one object.
+ *
+ *  A token bucket holds up to a burst of tokens and refills at a rate per
+ *  minute, every event sent takes a token. The latest value that found no
+ *  token, or no room in the event queue, is held back as the trailing value
+ *  and sent once a token refills, so the event log ends up at the current
+ *  value. The caller passes the time, the limiter never reads a clock.
+ */
+class EventLimiter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief What to do with a new value */
+    enum class Verdict
+    {
+        /** @brief Send it, then call sent() */
+        send,
+        /** @brief Drop it, it repeats the last value sent */
+        repeat,
+        /** @brief Out of tokens, it is held back as the trailing value */
+        limited,
+    };
+
+    EventLimiter() = delete;
+
+    /** @brief Constructs EventLimiter object with a full bucket.
+     *
+     *  @param[in] now - current time
+     *  @param[in] burst - size of the bucket
+     *  @param[in] ratePerMinute - tokens refilled per minute
+     */
+    EventLimiter(Clock::time_point now, double burst, double ratePerMinute);
+
+    /** @brief Decide on a new value.
+     *
+     *  @param[in] value - the new value
+     *  @param[in] suppressRepeats - drop a value that repeats the last one
+     *                               sent, false for events that report an
+     *                               action rather than a value
+     *  @param[in] now - current time
+     */
+    Verdict offer(const std::string& value, bool suppressRepeats,
+                  Clock::time_point now);
+
+    /** @brief Hold back a value that was let through but not sent.
+     *
+     *  @param[in] value - the value
+     */
+    void hold(const std::string& value);
+
+    /** @brief Take a token for a value that is sent.
+     *
+     *  @param[in] value - the value
+     *
+     *  @return The number of values that were rate limited since the
+     *          previous one sent.
+     */
+    uint64_t sent(const std::string& value);
+
+    /** @brief The trailing value if it gets a token now. A trailing value
+     *         that repeats the last one sent is dropped instead.
+     *
+     *  @param[in] now - current time
+     */
+    std::optional<std::string> dueTrailing(Clock::time_point now);
+
+    /** @brief When the trailing value gets a token, std::nullopt if no value
+     *         is held back.
+     */
+    std::optional<Clock::time_point> trailingDue() const;
+
+    /** @brief Number of values rate limited since the last one sent */
+    uint64_t limited() const
+    {
+        return suppressed;
+    }
+
+  private:
+    void refill(Clock::time_point now);
+
+    /** @brief Refill time of one token */
+    Clock::duration interval;
+    /** @brief Refill time of the whole bucket */
+    Clock::duration capacity;
+    /** @brief The tokens in the bucket as the time it took to refill them.
+     *         Counting clock ticks instead of fractional tokens makes a
+     *         token refill exactly when trailingDue() says it does.
+     */
+    Clock::duration credit;
+    Clock::time_point refilled;
+    /** @brief Last value sent */
+    std::optional<std::string> lastValue;
+    std::optional<std::string> trailing;
+    bool suppressRepeats = true;
+    uint64_t suppressed = 0;
+};
+
+} // namespace bios_config
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace bios_config
+{
+
+namespace fs = std::filesystem;
+
+/** @struct JournalContents
+ *
+ *  @brief The valid part of a write-ahead journal.
+ */
+struct JournalContents
+{
+    /** @brief Sequence number of the first record */
+    uint64_t base;
+    /** @brief Record payloads in append order */
+    std::vector<std::string> records;
+    /** @brief Size in bytes of the header and the valid records */
+    size_t size;
+};
+
+/** @brief Read the records of a write-ahead journal.
+ *
+ *  Records after the first torn or corrupted one are dropped and, when
+ *  repairing, the file is truncated there, so later appends follow the last
+ *  good record.
+ *
+ *  @param[in] path - path to the journal file
+ *  @param[in] repair - truncate the file after the last good record
+ *
+ *  @return The journal contents, std::nullopt if the journal is missing or
+ *          its header is unreadable.
+ */
+std::optional<JournalContents> readJournal(const fs::path& path,
+                                           bool repair = true);
+
+/** @brief Append records to a journal with a single write and sync.
+ *
+ *  @param[in] path - path to the journal file, started with resetJournal()
+ *  @param[in] records - encoded record payloads
+ *
+ *  @return The size of the journal after the append. Throws
+ *          std::system_error on I/O failure.
+ */
+size_t appendJournal(const fs::path& path,
+                     const std::vector<std::string>& records);
+
+/** @brief Atomically replace a journal with an empty one.
+ *
+ *  @param[in] path - path to the journal file
+ *  @param[in] firstSeq - sequence number of the first record appended next
+ *
+ *  @return The size of the empty journal. Throws std::system_error on I/O
+ *          failure.
+ */
+size_t resetJournal(const fs::path& path, uint64_t firstSeq);
+
+} // namespace bios_config
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+/** @brief Password key derivation functions, as selected by the seedData
+ *         file. The work factor of each is a parameter, so a platform can
+ *         pick one that is costly to attack without stalling its BMC.
+ */
+namespace bios_config_pwd::kdf
+{
+
+enum class Algorithm
+{
+    pbkdf2Sha256,
+    pbkdf2Sha384,
+    pbkdf2Sha512,
+    scrypt,
+    argon2id,
+};
+
+constexpr std::array<Algorithm, 5> algorithms = {
+    Algorithm::pbkdf2Sha256, Algorithm::pbkdf2Sha384, Algorithm::pbkdf2Sha512,
+    Algorithm::scrypt, Algorithm::argon2id};
+
+/** @brief PBKDF2 iteration count of seedData files that do not set one */
+constexpr uint32_t defaultPbkdf2Iterations = 1000;
+
+/** @struct Params
+ *
+ *  @brief An algorithm and its work factor. Fields an algorithm does not use
+ *         are ignored.
+ */
+struct Params
+{
+    Algorithm algorithm;
+    /** @brief PBKDF2 iterations, scrypt N (a power of 2) or Argon2 passes */
+    uint32_t iterations;
+    /** @brief Argon2 memory cost, upper bound of the scrypt memory use */
+    uint32_t memoryKiB;
+    /** @brief scrypt r */
+    uint32_t blockSize;
+    /** @brief scrypt p or Argon2 lanes */
+    uint32_t parallelism;
+    /** @brief Size of the derived hash in bytes */
+    uint32_t length;
+};
+
+/** @brief Look up an algorithm by its seedData name.
+ *
+ *  @param[in] name - "SHA256", "SHA384", "SHA512", "SCRYPT" or "ARGON2ID"
+ *
+ *  @return The algorithm, or std::nullopt if the name is unknown.
+ */
+std::optional<Algorithm> parseAlgorithm(std::string_view name);
+
+/** @brief The seedData name of an algorithm. */
+std::string_view algorithmName(Algorithm algorithm);
+
+/** @brief Default parameters of an algorithm, the ones the seedData file
+ *         does not override.
+ */
+Params defaults(Algorithm algorithm);
+
+/** @brief Whether the linked OpenSSL provides an algorithm. */
+bool available(Algorithm algorithm);
+
+/** @brief Derive a hash.
+ *
+ *  @param[in] params - algorithm and work factor
+ *  @param[in] password - password bytes
+ *  @param[in] salt - salt bytes
+ *  @param[out] out - receives the hash, params.length bytes
+ *
+ *  @return Throws std::invalid_argument if the parameters are invalid or do
+ *          not match out, and std::runtime_error if OpenSSL fails or lacks
+ *          the algorithm.
+ */
+void derive(const Params& params, std::span<const uint8_t> password,
+            std::span<const uint8_t> salt, std::span<uint8_t> out);
+
+} // namespace bios_config_pwd::kdf
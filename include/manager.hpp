@@ -17,6 +17,12 @@
 
 #include "config.h"
 
+#include "attribute_table.hpp"
+#include "manager_serialize.hpp"
+#include "persist_scheduler.hpp"
+#include "table_image.hpp"
+#include "worker.hpp"
+
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/server.hpp>
 #include <xyz/openbmc_project/BIOSConfig/BootOption/server.hpp>
@@ -26,22 +32,18 @@
 #include <xyz/openbmc_project/BIOSConfig/SecureBoot/server.hpp>
 #include <xyz/openbmc_project/Object/Delete/server.hpp>
 
+#include <array>
+#include <bitset>
 #include <filesystem>
+#include <memory>
 #include <string>
-#define BIOS_CONFIG_VERSION_1 1
-// Version 1: Bios table type 1
-#define BIOS_CONFIG_VERSION_2 2
-// Version 2: Bios table type 2 + version +
-// pendingBootEnable - The type remain map of variant (bool and string), but
-// additional bool was added. Version 3: Bios table type 2 + version +
-// credentialBootstrapFlag
-#define BIOS_CONFIG_VERSION 3
 
 namespace bios_config
 {
 
 static constexpr auto service = "xyz.openbmc_project.BIOSConfigManager";
 static constexpr auto objectPath = "/xyz/openbmc_project/bios_config/manager";
+static constexpr auto extInterfaceName = "com.nvidia.BIOSConfig.Manager";
 constexpr auto biosPersistFile = "biosData";
 static constexpr auto bootOptionsPath =
     "/xyz/openbmc_project/bios_config/bootOptions";
@@ -89,22 +91,7 @@ class BootOptionDbus : public BootOptionDbusBase
 class Manager : public Base
 {
   public:
-    using BaseTable = std::map<
-        std::string,
-        std::tuple<
-            AttributeType, bool, std::string, std::string, std::string,
-            std::variant<int64_t, std::string>,
-            std::variant<int64_t, std::string>,
-            std::vector<std::tuple<
-                BoundType, std::variant<int64_t, std::string>, std::string>>>>;
-
-    using BaseTableV1 = std::map<
-        std::string,
-        std::tuple<AttributeType, bool, std::string, std::string, std::string,
-                   std::variant<int64_t, std::string>,
-                   std::variant<int64_t, std::string>,
-                   std::vector<std::tuple<
-                       BoundType, std::variant<int64_t, std::string>>>>>;
+    using BaseTable = TableImage::BaseTable;
 
     // using ResetFlag = std::map<std::string, ResetFlag>;
 
@@ -121,6 +108,17 @@ class Manager : public Base
     using PendingValue = std::variant<int64_t, std::string>;
     using AttributeDetails =
         std::tuple<AttributeType, CurrentValue, PendingValue>;
+    using AttributeDetailsMap = std::map<AttributeName, AttributeDetails>;
+    /** @brief Attribute name, old and new current value and old and new
+     *         pending value, the values as GetAttribute returns them
+     */
+    using AttributeChange =
+        std::tuple<AttributeName, CurrentValue, CurrentValue, PendingValue,
+                   PendingValue>;
+    using AttributeValues =
+        std::vector<std::tuple<AttributeName, AttributeValue>>;
+    /** @brief Attribute name and D-Bus error name of each rejected value */
+    using AttributeErrors = std::vector<std::tuple<AttributeName, std::string>>;
     using BootOrderType = std::vector<std::string>;
     using BootOptionDataType =
         std::map<std::string, BootOptionDbus::PropertiesVariant>;
@@ -151,6 +149,19 @@ class Manager : public Base
      */
     void setAttribute(AttributeName attribute, AttributeValue value) override;
 
+    /** @brief Implementation for the SetAttributes method of
+     *         extInterfaceName. Sets many BIOS attributes at once, with one
+     *         validation pass, one PropertiesChanged and one flush.
+     *
+     *  @param[in] values - attribute names and new values, the type of each
+     *                      value is determined like for setAttribute()
+     *
+     *  @return The attributes that failed the validation with the D-Bus
+     *          error each of them would get from SetAttribute. Nothing is
+     *          set unless it is empty.
+     */
+    AttributeErrors setAttributes(AttributeValues values);
+
     /** @brief Get the details of the BIOS attribute
      *
      *  @param[in] attribute - attribute name
@@ -160,6 +171,80 @@ class Manager : public Base
      */
     AttributeDetails getAttribute(AttributeName attribute) override;
 
+    /** @brief Implementation for the GetAttributes method of
+     *         extInterfaceName. Gets the details of many attributes in one
+     *         call, all from the same state of the tables.
+     *
+     *  @param[in] names - attribute names
+     *
+     *  @return The details like getAttribute() returns them, by name.
+     *          Names the BaseBIOSTable does not have are left out.
+     */
+    AttributeDetailsMap
+        getAttributes(const std::vector<AttributeName>& names) const;
+
+    /** @brief Implementation for the GetAllAttributes method of
+     *         extInterfaceName.
+     *
+     *  @return The details of every attribute of the BaseBIOSTable, by
+     *          name.
+     */
+    AttributeDetailsMap getAllAttributes() const;
+
+    /** @brief Implementation for the ListMenu method of extInterfaceName.
+     *
+     *  @param[in] path - menu path, "" for the top level menus
+     *  @param[in] offset - index of the first submenu to return
+     *  @param[in] limit - maximum number of submenus to return, 0 for all
+     *
+     *  @return The names of the submenus on the page, in name order, and the
+     *          number of submenus of the menu. Throws ResourceNotFound if no
+     *          attribute is in or below the menu.
+     */
+    std::tuple<std::vector<std::string>, uint32_t>
+        listMenu(const std::string& path, uint32_t offset,
+                 uint32_t limit) const;
+
+    /** @brief Implementation for the GetMenuAttributes method of
+     *         extInterfaceName.
+     *
+     *  @param[in] path - menu path
+     *  @param[in] offset - index of the first attribute to return
+     *  @param[in] limit - maximum number of attributes to return, 0 for all
+     *
+     *  @return The attributes on the page, in the format of BaseBIOSTable,
+     *          and the number of attributes directly in the menu. Throws
+     *          ResourceNotFound if no attribute is in or below the menu.
+     */
+    std::tuple<BaseTable, uint32_t>
+        getMenuAttributes(const std::string& path, uint32_t offset,
+                          uint32_t limit) const;
+
+    /** @brief Implementation for the GetBaseBIOSTableIfModified method of
+     *         extInterfaceName.
+     *
+     *  @param[in] generation - BaseBIOSTableGeneration the caller has the
+     *                          table of
+     *
+     *  @return The current BaseBIOSTableGeneration, and the BaseBIOSTable if
+     *          it differs from the given one, otherwise an empty map.
+     */
+    std::tuple<uint64_t, BaseTable>
+        getBaseBIOSTableIfModified(uint64_t generation) const;
+
+    /** @brief Implementation for the GetPendingAttributesIfModified method
+     *         of extInterfaceName.
+     *
+     *  @param[in] generation - PendingAttributesGeneration the caller has
+     *                          the pending attributes of
+     *
+     *  @return The current PendingAttributesGeneration, and the
+     *          PendingAttributes if it differs from the given one, otherwise
+     *          an empty map.
+     */
+    std::tuple<uint64_t, PendingAttributes>
+        getPendingAttributesIfModified(uint64_t generation) const;
+
     /** @brief Set the BaseBIOSTable property and clears the PendingAttributes
      *         property
      *
@@ -169,6 +254,27 @@ class Manager : public Base
      */
     BaseTable baseBIOSTable(BaseTable value) override;
 
+    /** @brief Get the BaseBIOSTable property. The table is kept as an image
+     *         and only decoded when the whole property is read.
+     *
+     *  @return The BaseBIOSTable.
+     */
+    BaseTable baseBIOSTable() const override;
+
+    /** @brief Implementation for the UpdateBaseBIOSTable method of
+     *         extInterfaceName. Applies a delta to the BaseBIOSTable instead
+     *         of replacing it, drops the pending values of the attributes it
+     *         changes or removes and signals only the delta.
+     *
+     *  @param[in] upserts - attributes to add or replace
+     *  @param[in] removals - names of attributes to remove, names the table
+     *                        does not have are ignored
+     *
+     *  @return On error, throw exception
+     */
+    void updateBaseBIOSTable(BaseTable upserts,
+                             std::vector<std::string> removals);
+
     bool enableAfterReset(bool value) override;
 
     bool credentialBootstrap(bool value) override;
@@ -188,6 +294,13 @@ class Manager : public Base
      */
     PendingAttributes pendingAttributes(PendingAttributes value) override;
 
+    /** @brief Get the PendingAttributes property, built from the values
+     *         kept by attribute ID.
+     *
+     *  @return The PendingAttributes.
+     */
+    PendingAttributes pendingAttributes() const override;
+
     /** @brief Implementation for CreateBootOption To create a new DBus object
      *  with BootOption DBus interface and using the Id as the object name.
      *
@@ -198,6 +311,16 @@ class Manager : public Base
     void createBootOption(std::string id) override;
 
     void deleteBootOption(const std::string& key);
+
+    /** @brief Update properties of a boot option and persist them, unless
+     *         they already have the given values.
+     *
+     *  @param[in] key - key of the boot option
+     *  @param[in] changes - the new property values
+     */
+    void updateBootOption(const std::string& key,
+                          const BootOptionDataType& changes);
+
     BootOptionsType getBootOptionValues() const;
     void setBootOptionValues(const BootOptionsType& loaded);
 
@@ -223,49 +346,165 @@ class Manager : public Base
     bool enable(bool value) override;
     ModeType mode(ModeType value) override;
 
-    friend class BootOptionDbus;
+    /** @brief Write any changes that are still waiting for the persistence
+     *         scheduler to the persisted files right away, and wait for the
+     *         writer thread to finish them. Marks the files clean if
+     *         everything was written, so the next start keeps the
+     *         generations.
+     */
+    void flushSerialize();
 
-    BaseTable
-        convertBaseTableV1ToBaseTable(const Manager::BaseTableV1& tableV1);
+    friend class BootOptionDbus;
 
   private:
-    /** @enum Index into the fields in the BaseBIOSTable
-     */
-    enum class Index : uint8_t
-    {
-        attributeType = 0,
-        readOnly,
-        displayName,
-        description,
-        menuPath,
-        currentValue,
-        defaultValue,
-        options,
-    };
-
-    bool validateEnumOption(
-        const std::string& attrValue,
-        const std::vector<std::tuple<
-            BoundType, std::variant<int64_t, std::string>, std::string>>&
-            options);
-
-    bool validateStringOption(
-        const std::string& attrValue,
-        const std::vector<std::tuple<
-            BoundType, std::variant<int64_t, std::string>, std::string>>&
-            options);
-
-    bool validateIntegerOption(
-        const int64_t& attrValue,
-        const std::vector<std::tuple<
-            BoundType, std::variant<int64_t, std::string>, std::string>>&
-            options);
+    /** @brief Validate and apply changes to the pending attributes, without
+     *         building the PendingAttributes property.
+     *
+     *  @param[in] value - attributes to add or change, clears the pending
+     *                     attributes if empty
+     */
+    void updatePendingAttributes(const PendingAttributes& value);
+
+    /** @brief Build the details of an attribute as GetAttribute returns
+     *         them.
+     *
+     *  @param[in] id - attribute ID
+     */
+    AttributeDetails attributeDetails(uint32_t id) const;
+
+    /** @brief Determine the pending value for a value given without its
+     *         type: the type of a pending value of the attribute, otherwise
+     *         Integer or String by the value itself.
+     *
+     *  @param[in] attribute - attribute name
+     *  @param[in] value - the value
+     */
+    PendingAttribute toPendingAttribute(const AttributeName& attribute,
+                                        AttributeValue value) const;
+
+    /** @brief Validate a pending value against the BaseBIOSTable.
+     *
+     *  @param[in] name - attribute name
+     *  @param[in] value - the pending value
+     *
+     *  @return The attribute ID. Throws AttributeNotFound or InvalidArgument
+     *          if the value cannot be set.
+     */
+    uint32_t checkPendingAttribute(const std::string& name,
+                                   const PendingAttribute& value) const;
+
+    /** @brief Apply validated changes to the pending attributes.
+     *
+     *  @param[in] value - attributes to add or change
+     *  @param[in] ids - attribute ID of each of them, in the same order
+     */
+    void applyPendingAttributes(const PendingAttributes& value,
+                                const std::vector<uint32_t>& ids);
+
+    /** @brief Emit PropertiesChanged for a property of the Manager
+     *         interface whose value is served by a getter override.
+     *
+     *  @param[in] property - property name
+     */
+    void emitChanged(const char* property);
+
+    /** @brief Emit PropertiesChanged for a map property, unless it has more
+     *         entries than FULL_MAP_SIGNAL_LIMIT.
+     *
+     *  @param[in] property - property name
+     *  @param[in] entries - number of entries of the map
+     */
+    void emitMapChanged(const char* property, size_t entries);
+
+    static AttributeChange attributeChange(std::string_view name,
+                                           const AttributeDetails& before,
+                                           const AttributeDetails& after);
+
+    /** @brief Emit the AttributeChanged signal of extInterfaceName, unless
+     *         nothing changed.
+     *
+     *  @param[in] changes - the changed attributes
+     */
+    void emitAttributeChanged(const std::vector<AttributeChange>& changes);
+
+    /** @brief Increment the generation number of a part of the state after
+     *         it changed. The number is persisted with the next flush.
+     *
+     *  @param[in] generation - the changed part
+     */
+    void bumpGeneration(Generation generation);
+
+    /** @brief Copy the state of one persisted section.
+     *
+     *  @param[in] section - the section to copy
+     *  @param[out] state - the copy
+     */
+    void snapshot(Section section, Snapshot& state) const;
+
+    /** @brief Apply a loaded state, without persisting it or emitting
+     *         signals.
+     *
+     *  @param[in] state - the loaded state
+     */
+    void restore(const Snapshot& state);
+
+    /** @brief Mark a section as changed, the persistence scheduler rewrites
+     *         it once the changes settle.
+     *
+     *  @param[in] section - the changed section
+     */
+    void scheduleSerialize(Section section);
+
+    /** @brief Queue a delta record, the persistence scheduler appends it to
+     *         the journal once the changes settle.
+     *
+     *  @param[in] record - the change to persist
+     */
+    void scheduleSerialize(journal::Record record);
+
+    /** @brief Flush handler of the persistence scheduler. Takes a snapshot
+     *         of the queued delta records and changed sections and hands it
+     *         to the writer thread.
+     */
+    void persist();
+
+    /** @brief Completion of a batch written by the writer thread. Retries
+     *         what failed and compacts the journal once it grew too large.
+     *
+     *  @param[in] batch - the written batch
+     */
+    void persistDone(const Persistence::Batch& batch);
 
     sdbusplus::asio::object_server& objServer;
     std::shared_ptr<sdbusplus::asio::connection>& systemBus;
     std::filesystem::path biosFile;
+    /** @brief The BaseBIOSTable, indexed by attribute ID */
+    AttributeTable attributes;
+    /** @brief Values of the PendingAttributes property by attribute ID, the
+     *         property storage of the base class stays empty.
+     */
+    PendingStore pending;
     BootOptionsType bootOptionValues;
     std::map<std::string, std::unique_ptr<BootOptionDbus>> dbusBootOptions;
+    Persistence persistence;
+    PersistScheduler persistScheduler;
+    /** @brief Writer thread, declared after persistence so that it is
+     *         stopped before persistence is destroyed.
+     */
+    Worker worker;
+    bool persistInFlight = false;
+    bool persistAgain = false;
+    /** @brief Changes that were dropped because they did not change a value,
+     *         published as the ElidedWrites property of extInterfaceName.
+     */
+    uint64_t elidedWrites = 0;
+    /** @brief Indexed by Generation, published as properties of
+     *         extInterfaceName
+     */
+    std::array<uint64_t, generationCount> generations{};
+    /** @brief Generations that changed since the last flush */
+    std::bitset<generationCount> generationsChanged;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> extInterface;
 };
 
 } // namespace bios_config
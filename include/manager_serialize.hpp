@@ -1,28 +1,457 @@
 #pragma once
 
-#include "manager.hpp"
+#include "config.h"
 
+#include <xyz/openbmc_project/BIOSConfig/BootOption/server.hpp>
+#include <xyz/openbmc_project/BIOSConfig/Manager/server.hpp>
+#include <xyz/openbmc_project/BIOSConfig/SecureBoot/server.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
 #include <filesystem>
+#include <exception>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
 
 namespace bios_config
 {
 
-/** @brief Serialize and persist the bios manager object
+namespace fs = std::filesystem;
+
+class TableImage;
+
+/** @enum Section
+ *
+ *  @brief Independently persisted parts of the bios manager state. Each
+ *         section is stored in its own A/B slot file with its own format
+ *         version, so a change to one of them does not rewrite the others.
+ */
+enum class Section : uint8_t
+{
+    baseTable = 0,
+    pendingAttributes,
+    /** @brief EnableAfterReset and CredentialBootstrap */
+    settings,
+    /** @brief BootOrder and PendingBootOrder */
+    bootOrder,
+    bootOptions,
+    /** @brief CurrentBoot, Enable and Mode of the SecureBoot interface */
+    secureBoot,
+    generations,
+};
+
+constexpr size_t sectionCount = 7;
+
+/** @enum Generation
+ *
+ *  @brief Parts of the state that clients cache. Each has a generation
+ *         number that every change of the part increments, so a client
+ *         only needs to fetch a part again when its number moved.
+ */
+enum class Generation : uint8_t
+{
+    baseTable = 0,
+    pendingAttributes,
+    /** @brief BootOrder, PendingBootOrder and the boot options */
+    boot,
+    secureBoot,
+};
+
+constexpr size_t generationCount = 4;
+
+/** @brief Delta records appended to the journal next to the persisted
+ *         sections. Replaying them on top of the sections restores the state
+ *         without rewriting a whole section for every change. The order of
+ *         the Record alternatives is part of the on-disk format, new record
+ *         types must only be appended.
+ */
+namespace journal
+{
+
+using AttributeType =
+    sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::AttributeType;
+using BoundType =
+    sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::BoundType;
+using BaseTable = std::map<
+    std::string,
+    std::tuple<AttributeType, bool, std::string, std::string, std::string,
+               std::variant<int64_t, std::string>,
+               std::variant<int64_t, std::string>,
+               std::vector<std::tuple<BoundType,
+                                      std::variant<int64_t, std::string>,
+                                      std::string>>>>;
+using BootOptionValue = sdbusplus::xyz::openbmc_project::BIOSConfig::server::
+    BootOption::PropertiesVariant;
+using CurrentBootType = sdbusplus::xyz::openbmc_project::BIOSConfig::server::
+    SecureBoot::CurrentBootType;
+using ModeType =
+    sdbusplus::xyz::openbmc_project::BIOSConfig::server::SecureBoot::ModeType;
+
+struct PendingAttribute
+{
+    std::string name;
+    std::tuple<AttributeType, std::variant<int64_t, std::string>> value;
+};
+
+struct ClearPendingAttributes
+{};
+
+struct BootOption
+{
+    std::string key;
+    std::map<std::string, BootOptionValue> values;
+};
+
+struct DeleteBootOption
+{
+    std::string key;
+};
+
+/** @brief Only replayed from journals of earlier releases, a BootOrder
+ *         change is journaled as BootOrderChange
+ */
+struct BootOrder
+{
+    std::vector<std::string> value;
+};
+
+struct PendingBootOrder
+{
+    std::vector<std::string> value;
+};
+
+struct EnableAfterReset
+{
+    bool value;
+};
+
+struct CredentialBootstrap
+{
+    bool value;
+};
+
+struct CurrentBoot
+{
+    CurrentBootType value;
+};
+
+struct SecureBootEnable
+{
+    bool value;
+};
+
+struct SecureBootMode
+{
+    ModeType value;
+};
+
+/** @brief Attributes added to, changed in or removed from the BaseBIOSTable
+ *         without replacing it.
+ */
+struct BaseTableDelta
+{
+    BaseTable upserts;
+    std::vector<std::string> removals;
+};
+
+/** @brief Pending values dropped because their attribute changed */
+struct DropPendingAttributes
+{
+    std::vector<std::string> names;
+};
+
+struct GenerationNumber
+{
+    Generation generation;
+    uint64_t value;
+};
+
+/** @brief A BootOrder change with the PendingBootOrder it left behind */
+struct BootOrderChange
+{
+    std::vector<std::string> value;
+    std::vector<std::string> pending;
+};
+
+using Record =
+    std::variant<PendingAttribute, ClearPendingAttributes, BootOption,
+                 DeleteBootOption, BootOrder, PendingBootOrder,
+                 EnableAfterReset, CredentialBootstrap, CurrentBoot,
+                 SecureBootEnable, SecureBootMode, BaseTableDelta,
+                 DropPendingAttributes, GenerationNumber, BootOrderChange>;
+
+} // namespace journal
+
+/** @struct Snapshot
  *
- *  @param[in] obj - bios manager object
- *  @param[in] path - path to the file where the bios manager object
- *                    is to be serialized
+ *  @brief Copy of the persisted state of the bios manager object. Loading
+ *         decodes the files into it and a flush copies the sections being
+ *         written into it, so neither needs the D-Bus object and the file
+ *         I/O can run off the io loop while the object keeps changing.
  */
-void serialize(const Manager& obj, const fs::path& path);
+struct Snapshot
+{
+    std::shared_ptr<const TableImage> baseTable;
+    std::map<std::string, std::tuple<journal::AttributeType,
+                                     std::variant<int64_t, std::string>>>
+        pendingAttributes;
+    bool enableAfterReset = false;
+    bool credentialBootstrap = false;
+    std::vector<std::string> bootOrder;
+    std::vector<std::string> pendingBootOrder;
+    std::map<std::string, std::map<std::string, journal::BootOptionValue>>
+        bootOptions;
+    journal::CurrentBootType currentBoot{};
+    bool enable = false;
+    journal::ModeType mode{};
+    /** @brief Indexed by Generation */
+    std::array<uint64_t, generationCount> generations{};
+};
 
-/** @brief Deserialize the persisted data and populate the bios manager object
+/** @brief Name of a section, as used in its file name.
  *
- *  @param[in] path - path to the persisted file
- *  @param[in/out] entry - reference to the bios manager object which is the
- *                         target of deserialization.
+ *  @param[in] section - the section
+ */
+const char* sectionName(Section section);
+
+/** @brief Base path of the A/B slot files of a section.
+ *
+ *  @param[in] path - base path of the persisted files
+ *  @param[in] section - the section
+ */
+fs::path sectionPath(const fs::path& path, Section section);
+
+/** @brief Write a state as the unframed whole-state archive of an earlier
+ *         release, so it can be loaded after a downgrade.
+ *
+ *  @param[in] path - file to write
+ *  @param[in] state - the state to archive
+ *  @param[in] version - archive version, 1 to 3
  *
- *  @return bool - true if the deserialization was successful, false otherwise.
+ *  @return Throws std::invalid_argument for an unknown version and
+ *          std::system_error on I/O failure.
  */
-bool deserialize(const fs::path& path, Manager& entry);
+void saveLegacy(const fs::path& path, const Snapshot& state,
+                uint32_t version);
+
+/** @class Persistence
+ *
+ *  @brief Keeps the persisted sections and the journal of the bios manager
+ *         object up to date.
+ *
+ *  Changes are queued either as journal records or as whole sections to
+ *  rewrite, and written together by a flush. Every journal record carries an
+ *  implicit sequence number and every section records the first sequence
+ *  number it does not contain yet, so startup replays exactly the records
+ *  that are newer than each section.
+ */
+class Persistence
+{
+  public:
+    /** @struct Fingerprint
+     *
+     *  @brief Identifies the contents of a section as it was last written,
+     *         a rewrite with the same size and checksum is skipped.
+     */
+    struct Fingerprint
+    {
+        uint64_t size = 0;
+        /** @brief CRC32C of the payload, or the checksum of the table image */
+        uint32_t crc = 0;
+
+        bool operator==(const Fingerprint&) const = default;
+    };
+
+    /** @struct Batch
+     *
+     *  @brief One flush, prepared on the io loop, written by write() on the
+     *         writer thread and applied back by complete().
+     */
+    struct Batch
+    {
+        std::vector<journal::Record> records;
+        /** @brief Sequence number of the first record */
+        uint64_t firstSeq = 0;
+        /** @brief Sections the records belong to */
+        std::bitset<sectionCount> touched;
+        /** @brief Sections to rewrite */
+        std::bitset<sectionCount> sections;
+        /** @brief Sections with records in the journal before this batch */
+        std::bitset<sectionCount> journaled;
+        Snapshot state;
+        std::array<std::optional<Fingerprint>, sectionCount> fingerprints;
+        bool journalValid = false;
+        bool journalEmpty = false;
+        bool removeLegacy = false;
+        /** @brief The clean-shutdown marker must go before anything else is
+         *         written
+         */
+        bool removeClean = false;
+
+        /** @brief Results, filled by write() */
+        bool appended = false;
+        bool journalReset = false;
+        size_t journalSize = 0;
+        /** @brief Sections that are up to date on disk */
+        std::bitset<sectionCount> written;
+        uint64_t elided = 0;
+        bool legacyRemoved = false;
+        bool cleanRemoved = false;
+        std::exception_ptr error;
+    };
+
+    Persistence() = delete;
+    ~Persistence() = default;
+    Persistence(const Persistence&) = delete;
+    Persistence& operator=(const Persistence&) = delete;
+    Persistence(Persistence&&) = delete;
+    Persistence& operator=(Persistence&&) = delete;
+
+    /** @brief Constructs Persistence object.
+     *
+     *  @param[in] path - base path of the persisted files
+     *  @param[in] repair - move undecodable files aside and cut torn records
+     *                      off the journal while loading
+     */
+    explicit Persistence(const fs::path& path, bool repair = true);
+
+    /** @brief Deserialize the persisted sections and replay the journal on
+     *         top of them, migrating the whole-state file written by
+     *         earlier releases.
+     *
+     *  @param[in/out] state - target of deserialization, sections that are
+     *                         not persisted keep their values
+     *
+     *  @return bool - true if any persisted state was loaded.
+     */
+    bool load(Snapshot& state);
+
+    /** @brief Whether the previous run flushed everything and marked the
+     *         files clean before it stopped. Valid after load(), which
+     *         removes the marker.
+     */
+    bool cleanShutdown() const
+    {
+        return clean;
+    }
+
+    /** @brief Record on disk that the files hold every change, to be found
+     *         by load() on the next start. The next batch written removes
+     *         the marker again.
+     *
+     *  @return bool - false if changes are still queued and nothing was
+     *          marked. Throws std::system_error on I/O failure.
+     */
+    bool markClean();
+
+    /** @brief Check the persisted files without loading them.
+     *
+     *  @return One message per slot, image or journal record that fails its
+     *          checksum or cannot be decoded, empty if all files are intact.
+     */
+    std::vector<std::string> verify() const;
+
+    /** @brief Write every section of a state right away, on the calling
+     *         thread.
+     *
+     *  @param[in] state - the state to persist
+     *
+     *  @return Throws std::exception if a section cannot be written.
+     */
+    void save(const Snapshot& state);
+
+    /** @brief Queue a delta record for the journal.
+     *
+     *  @param[in] record - the change to persist
+     */
+    void record(journal::Record record);
+
+    /** @brief Queue a rewrite of a whole section.
+     *
+     *  @param[in] section - the section to rewrite
+     */
+    void markDirty(Section section);
+
+    /** @brief Request a rewrite of every section that still has records in
+     *         the journal, so the journal can be started over.
+     */
+    void compact();
+
+    /** @brief Take the queued records and sections for a flush. The caller
+     *         copies the state of the batch sections into the batch before
+     *         it is written.
+     *
+     *  @return The batch to write, or nullptr if nothing is queued.
+     */
+    std::shared_ptr<Batch> prepare();
+
+    /** @brief Encode and write a prepared batch. Only reads the paths of this
+     *         object, so it may run on another thread while the io loop keeps
+     *         queueing changes.
+     *
+     *  @param[in/out] batch - the batch, the results are stored in it
+     */
+    void write(Batch& batch) const;
+
+    /** @brief Apply the results of a written batch. Whatever failed is
+     *         queued again.
+     *
+     *  @param[in] batch - the written batch
+     *
+     *  @return bool - true if the journal outgrew the compaction threshold.
+     */
+    bool complete(const Batch& batch);
+
+    /** @brief Whether records or sections are queued for a flush.
+     *
+     *  @return bool - true if prepare() has anything to write.
+     */
+    bool pending() const;
+
+    /** @brief Number of section rewrites that were skipped because the
+     *         section did not change since it was last written.
+     */
+    uint64_t elidedWrites() const
+    {
+        return elided;
+    }
+
+  private:
+    void writeSection(Batch& batch, Section section, uint64_t seq) const;
+    bool loadSections(Snapshot& state);
+    bool migrate(Snapshot& state);
+
+    fs::path path;
+    fs::path journalFile;
+    fs::path cleanFile;
+    bool repair;
+    std::vector<journal::Record> records;
+    /** @brief Sections queued for a rewrite */
+    std::bitset<sectionCount> dirty;
+    /** @brief Sections that depend on records in the journal */
+    std::bitset<sectionCount> journaled;
+    /** @brief Sequence number of the next journal record */
+    uint64_t nextSeq = 0;
+    size_t journalSize = 0;
+    /** @brief The journal numbering lines up with the sections */
+    bool journalValid = false;
+    /** @brief The journal holds no records */
+    bool journalEmpty = false;
+    /** @brief Sections as they were last written or loaded */
+    std::array<std::optional<Fingerprint>, sectionCount> fingerprints;
+    uint64_t elided = 0;
+    /** @brief The whole-state file of an earlier release is still on disk */
+    bool legacyFiles = false;
+    /** @brief The previous run stopped after markClean() */
+    bool clean = false;
+    /** @brief The clean-shutdown marker is on disk */
+    bool cleanMarked = false;
+};
 
 } // namespace bios_config
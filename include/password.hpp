@@ -16,18 +16,28 @@
 #pragma once
 #include "config.h"
 
-#include <openssl/evp.h>
-#include <openssl/hmac.h>
-#include <openssl/sha.h>
+#include "kdf.hpp"
+#include "worker.hpp"
 
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
 #include <sdbusplus/asio/object_server.hpp>
-#include <sdbusplus/server.hpp>
 #include <xyz/openbmc_project/BIOSConfig/Password/server.hpp>
 
+#include <array>
+#include <chrono>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 
+struct stat;
+
 namespace bios_config_pwd
 {
 static constexpr auto objectPathPwd =
@@ -36,7 +46,6 @@ constexpr auto biosSeedFile = "seedData";
 constexpr uint8_t maxHashSize = 64;
 constexpr uint8_t maxSeedSize = 32;
 constexpr uint8_t maxPasswordLen = 32;
-constexpr int iterValue = 1000;
 
 using Base = sdbusplus::xyz::openbmc_project::BIOSConfig::server::Password;
 namespace fs = std::filesystem;
@@ -44,8 +53,20 @@ namespace fs = std::filesystem;
 /** @class Password
  *
  *  @brief Implements the BIOS Password
+ *
+ *  The interface is served by the object server, ChangePassword by a
+ *  coroutine handler that is suspended while the KDF work and the seedData
+ *  file I/O run on a worker thread. The reply is sent from the io loop once
+ *  they are done, so a password change does not stall the other BIOS config
+ *  requests. Calls are handled one at a time, in order.
+ *
+ *  The parsed seedData is kept in memory between calls. An inotify watch on
+ *  its directory drops the copy when another process, such as the host-side
+ *  provisioning flow, replaces or rewrites the file. Updates are written to
+ *  a temporary file, synced and renamed over seedData, so a crash never
+ *  leaves a torn admin hash behind.
  */
-class Password : public Base
+class Password
 {
   public:
     Password() = delete;
@@ -63,37 +84,162 @@ class Password : public Base
     Password(sdbusplus::asio::object_server& objectServer,
              std::shared_ptr<sdbusplus::asio::connection>& systemBus);
 
-    /** @brief Set the BIOS attribute with a new value, the new value is added
-     *         to the PendingAttribute.
+  private:
+    /** @struct Stamp
+     *
+     *  @brief Identifies one version of the seedData file.
+     */
+    struct Stamp
+    {
+        uint64_t device;
+        uint64_t inode;
+        int64_t size;
+        int64_t mtimeNs;
+
+        bool operator==(const Stamp&) const = default;
+    };
+
+    /** @struct SeedData
+     *
+     *  @brief The parsed seedData file.
+     */
+    struct SeedData
+    {
+        Stamp stamp{};
+        nlohmann::json json;
+        std::array<uint8_t, maxHashSize> orgUsrPwdHash{};
+        std::array<uint8_t, maxHashSize> orgAdminPwdHash{};
+        std::array<uint8_t, maxSeedSize> seed{};
+        /** @brief HashAlgo and the optional Iterations, MemoryKiB,
+         *         BlockSize, Parallelism and HashLength fields
+         */
+        kdf::Params params{};
+    };
+
+    /** @struct Call
+     *
+     *  @brief A ChangePassword call waiting for its reply.
+     */
+    struct Call
+    {
+        std::string userName;
+        std::string currentPassword;
+        std::string newPassword;
+        /** @brief Resumes the suspended handler with the result */
+        std::move_only_function<void(std::exception_ptr)> done;
+    };
+
+    /** @brief Handler of the ChangePassword method. Queues the call and
+     *         suspends until the worker is done with it.
      *
+     *  @param[in] yield - the coroutine of the call
      *  @param[in] userName - User name - user / admin.
      *  @param[in] currentPassword - Current user/ admin Password.
      *  @param[in] newPassword - New user/ admin Password.
+     *
+     *  @return Throws the D-Bus error to reply with on failure.
      */
-    void changePassword(std::string userName, std::string currentPassword,
-                        std::string newPassword) override;
-
-  private:
-    void verifyPassword(std::string userName, std::string currentPassword,
+    void changePassword(boost::asio::yield_context yield,
+                        std::string userName, std::string currentPassword,
                         std::string newPassword);
-    bool compareDigest(const EVP_MD* digestFunc, size_t digestLen,
-                       const std::array<uint8_t, maxHashSize>& expected,
-                       const std::array<uint8_t, maxSeedSize>& seed,
-                       const std::string& rawData);
-    bool isMatch(const std::array<uint8_t, maxHashSize>& expected,
-                 const std::array<uint8_t, maxSeedSize>& seed,
-                 const std::string& rawData, const std::string& algo);
-    bool getParam(std::array<uint8_t, maxHashSize>& orgUsrPwdHash,
-                  std::array<uint8_t, maxHashSize>& orgAdminPwdHash,
-                  std::array<uint8_t, maxSeedSize>& seed,
-                  std::string& hashAlgo);
-    bool verifyIntegrityCheck(std::string& newPassword,
-                              std::array<uint8_t, maxSeedSize>& seed,
-                              unsigned int mdLen, const EVP_MD* digestFunc);
+
+    /** @brief Start the next queued ChangePassword call, unless one is
+     *         still in flight.
+     */
+    void startNext();
+
+    /** @brief Verify the current password and store the hash of the new
+     *         one. Runs on the worker thread, touches no members but the
+     *         seed file path.
+     *
+     *  @param[in/out] data - the cached seedData, parsed from the file if
+     *                        empty, set to what the file holds afterwards
+     *  @param[in] userName - User name - user / admin.
+     *  @param[in] currentPassword - Current user/ admin Password.
+     *  @param[in] newPassword - New user/ admin Password.
+     *
+     *  @return Throws the D-Bus error to reply with on failure.
+     */
+    void changePassword(std::shared_ptr<const SeedData>& data,
+                        const std::string& userName,
+                        const std::string& currentPassword,
+                        const std::string& newPassword) const;
+
+    /** @brief Resume the handler of the ChangePassword call in flight and
+     *         start the next one. Runs on the io loop.
+     *
+     *  @param[in] error - what the worker job threw, if anything
+     */
+    void changePasswordDone(std::exception_ptr error);
+
+    /** @brief Measure how late the io loop runs a timer while the worker
+     *         hashes, to show the loop keeps serving requests meanwhile.
+     */
+    void probeLag();
+
+    /** @brief Watch the seedData directory, so the cached copy is dropped
+     *         when the file changes behind our back.
+     */
+    void watchSeedFile();
+
+    /** @brief Read the pending inotify events and drop the cached seedData
+     *         if the file no longer is the version it was read from.
+     */
+    void readSeedEvents();
+
+    /** @brief Stamp of the current seedData file, std::nullopt if it does
+     *         not exist.
+     */
+    std::optional<Stamp> seedStamp() const;
+    static Stamp stampOf(const struct stat& st);
+
+    static std::array<uint8_t, maxHashSize>
+        verifyPassword(const SeedData& data, const std::string& userName,
+                       const std::string& currentPassword,
+                       const std::string& newPassword);
+    static bool isMatch(const SeedData& data,
+                        const std::array<uint8_t, maxHashSize>& expected,
+                        const std::string& rawData);
+    SeedData getParam() const;
+
+    /** @brief Hash a password with the KDF and salt of the seedData.
+     *
+     *  @param[in] data - the seedData
+     *  @param[in] password - the password
+     *
+     *  @return The hash, zero padded. Throws InternalFailure if the KDF
+     *          fails.
+     */
+    static std::array<uint8_t, maxHashSize> hash(const SeedData& data,
+                                                 const std::string& password);
     sdbusplus::asio::object_server& objServer;
     std::shared_ptr<sdbusplus::asio::connection>& systemBus;
     std::filesystem::path seedFile;
-    std::array<uint8_t, maxHashSize> mNewPwdHash;
+
+    /** @brief ChangePassword calls waiting for a reply, the front one is in
+     *         flight if busy
+     */
+    std::deque<Call> calls;
+    bool busy = false;
+    std::chrono::steady_clock::time_point callStart;
+    boost::asio::steady_timer lagProbe;
+    std::chrono::steady_clock::time_point probeDeadline;
+    std::chrono::steady_clock::duration maxLag{};
+    bios_config::Worker worker;
+
+    /** @brief Parsed seedData, empty until first read or once invalidated */
+    std::shared_ptr<const SeedData> seedCache;
+    /** @brief Counts invalidations, a worker result read before the latest
+     *         one is not cached
+     */
+    uint64_t seedEpoch = 0;
+    /** @brief inotify descriptor, not open if the watch could not be set
+     *         up, in which case nothing is cached
+     */
+    boost::asio::posix::stream_descriptor seedWatch;
+    alignas(8) std::array<char, 4096> seedEvents{};
+    /** @brief Serves PasswordInitialized and ChangePassword */
+    std::shared_ptr<sdbusplus::asio::dbus_interface> pwdInterface;
 };
 
 } // namespace bios_config_pwd
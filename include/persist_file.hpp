@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bios_config
+{
+
+namespace fs = std::filesystem;
+
+/** @struct Slot
+ *
+ *  @brief One validated copy of a persisted file.
+ */
+struct Slot
+{
+    /** @brief Version of the payload encoding, chosen by the writer */
+    uint32_t format;
+    /** @brief Write counter, the slot with the highest one is the newest */
+    uint64_t generation;
+    std::string payload;
+};
+
+/** @brief Read both slots of an A/B persisted file.
+ *
+ *  Each slot starts with a header holding the payload format, the write
+ *  generation and CRC32C checksums of the header and the payload. Slots
+ *  that are missing, truncated or fail the checksum are skipped.
+ *
+ *  @param[in] path - base path of the persisted file
+ *
+ *  @return The valid slots, newest first.
+ */
+std::vector<Slot> readSlots(const fs::path& path);
+
+/** @brief Write a new generation of an A/B persisted file.
+ *
+ *  The payload replaces the older of the two slots, so the newest valid
+ *  copy is never touched while it is being superseded.
+ *
+ *  @param[in] path - base path of the persisted file
+ *  @param[in] format - version of the payload encoding
+ *  @param[in] payload - encoded data
+ *
+ *  @return The generation that was written. Throws std::system_error on
+ *          I/O failure.
+ */
+uint64_t writeSlot(const fs::path& path, uint32_t format,
+                   std::string_view payload);
+
+/** @brief Replace a file with new contents so that a crash or power loss
+ *         leaves either the old or the new contents, never a mix.
+ *
+ *  The data is written to a temporary file next to the target, synced,
+ *  renamed over the target and the directory entry is synced.
+ *
+ *  @param[in] path - file to replace
+ *  @param[in] data - new contents
+ *
+ *  @return Throws std::system_error on I/O failure.
+ */
+void writeFileAtomic(const fs::path& path, std::string_view data);
+
+/** @brief Remove a file and sync the directory entry, so the file does not
+ *         come back after a crash or power loss.
+ *
+ *  @param[in] path - file to remove
+ *
+ *  @return bool - true if the file existed. Throws std::system_error on I/O
+ *          failure.
+ */
+bool removeFile(const fs::path& path);
+
+} // namespace bios_config
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <functional>
+
+namespace bios_config
+{
+
+/** @class PersistScheduler
+ *
+ *  @brief Coalesces persistence requests into a single deferred flush.
+ *
+ *  Mutations only mark the state dirty. The flush handler runs once the
+ *  state has been quiet for the quiet period, and at the latest after the
+ *  max delay counted from the first unflushed change. A max delay of zero
+ *  flushes synchronously on every change.
+ */
+class PersistScheduler
+{
+  public:
+    using FlushHandler = std::function<void()>;
+
+    PersistScheduler() = delete;
+    ~PersistScheduler() = default;
+    PersistScheduler(const PersistScheduler&) = delete;
+    PersistScheduler& operator=(const PersistScheduler&) = delete;
+    PersistScheduler(PersistScheduler&&) = delete;
+    PersistScheduler& operator=(PersistScheduler&&) = delete;
+
+    /** @brief Constructs PersistScheduler object.
+     *
+     *  @param[in] io - io context the flush timer runs on
+     *  @param[in] handler - callback that writes the state to storage
+     *  @param[in] quietPeriod - time without changes before flushing
+     *  @param[in] maxDelay - upper bound between the first change and flush
+     */
+    PersistScheduler(boost::asio::io_context& io, FlushHandler handler,
+                     std::chrono::milliseconds quietPeriod,
+                     std::chrono::milliseconds maxDelay);
+
+    /** @brief Mark the state as changed and (re)arm the flush timer. */
+    void markDirty();
+
+    /** @brief Run the flush handler now if there are unflushed changes. */
+    void flush();
+
+    /** @brief Keep the changes of a failed flush pending and retry once the
+     *         max delay expires.
+     */
+    void retry();
+
+    /** @brief Whether there are changes that are not flushed yet. */
+    bool dirty() const
+    {
+        return isDirty;
+    }
+
+  private:
+    void arm(std::chrono::steady_clock::time_point deadline);
+
+    boost::asio::steady_timer timer;
+    FlushHandler handler;
+    std::chrono::milliseconds quietPeriod;
+    std::chrono::milliseconds maxDelay;
+    bool isDirty = false;
+    std::chrono::steady_clock::time_point firstDirty;
+};
+
+} // namespace bios_config
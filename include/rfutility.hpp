@@ -15,14 +15,74 @@
  * limitations under the License.
  */
 #pragma once
+#include <sdbusplus/asio/connection.hpp>
+
+#include <cstdint>
+#include <memory>
 #include <string>
 namespace bios_config
 {
 
+/** @brief Send the queued Redfish events on a connection from now on.
+ *
+ *  Events are queued by the functions below and sent by one pass of the io
+ *  loop after the handler that raised them returns, one asynchronous
+ *  Logging.Create call per event, so no handler waits on the logging
+ *  service. Events raised before this is called are dropped.
+ *
+ *  @param[in] conn - the connection of the service
+ */
+void startRedfishEvents(std::shared_ptr<sdbusplus::asio::connection> conn);
+
+/** @brief Release the connection and the timer of the event queue. Called
+ *         before the io context is destroyed, events raised afterwards are
+ *         dropped.
+ */
+void stopRedfishEvents();
+
+/** @struct RedfishEventStats
+ *
+ *  @brief Counts of the Redfish events raised since startup.
+ */
+struct RedfishEventStats
+{
+    /** @brief Logged by the logging service */
+    uint64_t sent = 0;
+    /** @brief Rejected by the logging service or not delivered to it */
+    uint64_t failed = 0;
+    /** @brief Suppressed because they repeated the last value sent for their
+     *         property and object path
+     */
+    uint64_t duplicates = 0;
+    /** @brief Suppressed by the rate limit of their property and object path
+     */
+    uint64_t rateLimited = 0;
+    /** @brief Dropped because too many events were queued in one tick */
+    uint64_t dropped = 0;
+};
+
+/** @brief Counts of the events raised so far. */
+const RedfishEventStats& redfishEventStats();
+
 void parsePropertyValueAndSendEvent(const std::string propertyName,
                                     const std::string dbusPropertyValue,
                                     const std::string objectPath);
+/** @brief Queue a PropertyValueModified event.
+ *
+ *  Events of each property and object path pass a token bucket of
+ *  REDFISH_EVENT_BURST events refilled at REDFISH_EVENT_RATE per minute,
+ *  and an event repeating the last value sent for them is suppressed. The
+ *  latest value held back by the rate limit is sent once a token refills,
+ *  so the event log always ends up at the current value.
+ *
+ *  @param[in] propertyName - name of the property
+ *  @param[in] propertyValue - its new value
+ *  @param[in] objectPath - object the property belongs to
+ *  @param[in] suppressRepeats - false for events that report an action
+ *                               rather than a value, which repeat on purpose
+ */
 void sendRedfishEvent(const std::string propertyName,
                       const std::string propertyValue,
-                      const std::string objectPath);
+                      const std::string objectPath,
+                      bool suppressRepeats = true);
 } // namespace bios_config
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <xyz/openbmc_project/BIOSConfig/Manager/server.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace bios_config
+{
+
+namespace fs = std::filesystem;
+
+/** @brief On-disk layout of a BaseBIOSTable image, in host byte order.
+ *
+ *  The image is a header followed by one column per attribute field, with
+ *  the attributes sorted by name, and a blob holding every distinct string
+ *  once. The fields a lookup, a validation or a scan over the whole table
+ *  reads (type, read-only flag, values and bound options) come first and
+ *  are packed per field, so such a pass touches contiguous memory only.
+ *  The display names, descriptions and menu paths, which are only read
+ *  when the table is handed out over D-Bus, follow in a cold region.
+ *  Strings are referred to by offset into the blob, so a repeated menu path
+ *  or enum label costs a reference instead of a copy. An updated image
+ *  appends the strings of the changed attributes instead, see
+ *  TableImage::update(). Every column starts at an 8 byte boundary.
+ */
+namespace image
+{
+
+constexpr uint32_t magic = 0x4d495442; // "BTIM"
+constexpr uint32_t version = 1;
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t optionCount;
+    uint64_t stringsSize;
+    /** @brief Blob bytes appended by TableImage::update() since the image
+     *         was built, the strings of replaced attributes stay behind
+     */
+    uint32_t patchedBytes;
+    /** @brief CRC32C over everything following the header */
+    uint32_t crc;
+};
+static_assert(sizeof(Header) == 32);
+
+/** @brief Location of a string in the blob */
+struct StrRef
+{
+    uint32_t offset;
+    uint32_t length;
+};
+static_assert(sizeof(StrRef) == 8);
+
+/** @brief An integer or string value */
+struct Value
+{
+    enum Kind : uint32_t
+    {
+        integer = 0,
+        string = 1,
+    };
+
+    uint32_t kind;
+    /** @brief Length of a string value */
+    uint32_t length;
+    /** @brief The integer, or the blob offset of a string value */
+    uint64_t data;
+};
+static_assert(sizeof(Value) == 16);
+
+/** @struct Layout
+ *
+ *  @brief Byte offsets of the columns, with n attributes and m options.
+ */
+struct Layout
+{
+    /** @brief uint8_t[n] AttributeType */
+    uint64_t types;
+    /** @brief uint8_t[n] */
+    uint64_t readOnly;
+    /** @brief Value[n] */
+    uint64_t currentValues;
+    /** @brief Value[n] */
+    uint64_t defaultValues;
+    /** @brief uint32_t[n + 1], the options of attribute i are the ones from
+     *         firstOption[i] up to firstOption[i + 1]
+     */
+    uint64_t firstOption;
+    /** @brief uint32_t[m] BoundType */
+    uint64_t bounds;
+    /** @brief Value[m] */
+    uint64_t optionValues;
+    /** @brief StrRef[n] */
+    uint64_t names;
+    /** @brief StrRef[n], start of the cold region */
+    uint64_t displayNames;
+    /** @brief StrRef[n] */
+    uint64_t descriptions;
+    /** @brief StrRef[n] */
+    uint64_t menuPaths;
+    /** @brief StrRef[m] */
+    uint64_t optionDescriptions;
+    uint64_t strings;
+    /** @brief Size of the whole image */
+    uint64_t size;
+};
+
+/** @brief Compute the column offsets of an image.
+ *
+ *  @param[in] header - header of the image
+ */
+Layout layout(const Header& header);
+
+} // namespace image
+
+/** @class TableImage
+ *
+ *  @brief Read-only BaseBIOSTable backed by an encoded image, either mapped
+ *         from a file or held in memory.
+ *
+ *  Attributes are looked up through the sorted name column and decoded on
+ *  access, the full table is only materialized when it is handed out over
+ *  D-Bus as a whole. A mapped image stays valid while its file is replaced
+ *  by rename.
+ */
+class TableImage
+{
+  public:
+    using AttributeType = sdbusplus::xyz::openbmc_project::BIOSConfig::
+        server::Manager::AttributeType;
+    using BoundType =
+        sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::BoundType;
+    using Value = std::variant<int64_t, std::string>;
+    using BaseTable = std::map<
+        std::string,
+        std::tuple<AttributeType, bool, std::string, std::string, std::string,
+                   Value, Value,
+                   std::vector<std::tuple<BoundType, Value, std::string>>>>;
+
+    /** @brief A value referring into the image */
+    using ValueView = std::variant<int64_t, std::string_view>;
+
+    /** @brief Attribute ID of no attribute */
+    static constexpr uint32_t noId = UINT32_MAX;
+
+    /** @struct Patch
+     *
+     *  @brief How update() maps the attributes of an image to the ones of
+     *         the image it returns.
+     */
+    struct Patch
+    {
+        /** @brief ID in the old image of each attribute of the new one,
+         *         noId for an added attribute
+         */
+        std::vector<uint32_t> previous;
+        /** @brief IDs in the new image of the upserted attributes */
+        std::vector<uint32_t> upserted;
+        /** @brief IDs in the old image of the removed attributes */
+        std::vector<uint32_t> removed;
+        /** @brief Whether attributes were added or removed, which moves the
+         *         IDs of the ones after them
+         */
+        bool renumbered = false;
+    };
+
+    /** @struct Option
+     *
+     *  @brief A bound option of an attribute, referring into the image.
+     */
+    struct Option
+    {
+        BoundType bound;
+        ValueView value;
+        std::string_view description;
+    };
+
+    /** @class Attribute
+     *
+     *  @brief An attribute of the image, read from the columns on access.
+     *         The views it returns are valid as long as the image is.
+     */
+    class Attribute
+    {
+      public:
+        std::string_view name() const;
+        AttributeType type() const;
+        bool readOnly() const;
+        std::string_view displayName() const;
+        std::string_view description() const;
+        std::string_view menuPath() const;
+        ValueView currentValue() const;
+        ValueView defaultValue() const;
+        std::vector<Option> options() const;
+
+        /** @brief Decode the attribute into its BaseBIOSTable entry */
+        BaseTable::mapped_type decode() const;
+
+        /** @brief Position of the attribute in name order */
+        uint32_t index() const
+        {
+            return id;
+        }
+
+      private:
+        friend class TableImage;
+        Attribute(const TableImage& image, uint32_t id) : image(&image), id(id)
+        {}
+
+        const TableImage* image;
+        uint32_t id;
+    };
+
+    TableImage() = delete;
+    ~TableImage();
+    TableImage(const TableImage&) = delete;
+    TableImage& operator=(const TableImage&) = delete;
+    TableImage(TableImage&&) = delete;
+    TableImage& operator=(TableImage&&) = delete;
+
+    /** @brief Encode a BaseBIOSTable into an in-memory image.
+     *
+     *  @param[in] table - the table to encode
+     *
+     *  @return The image. Throws std::length_error if the table does not fit
+     *          the 32-bit offsets of the format.
+     */
+    static std::shared_ptr<const TableImage> build(const BaseTable& table);
+
+    /** @brief Map an image file.
+     *
+     *  The header, the checksum and every offset are validated before the
+     *  image is returned.
+     *
+     *  @param[in] path - the image file
+     *
+     *  @return The image. Throws std::system_error if the file cannot be
+     *          mapped and std::runtime_error if it is not a valid image.
+     */
+    static std::shared_ptr<const TableImage> open(const fs::path& path);
+
+    /** @brief Look up an attribute by name.
+     *
+     *  @param[in] name - attribute name
+     *
+     *  @return The attribute, or std::nullopt if the table does not have it.
+     */
+    std::optional<Attribute> find(std::string_view name) const;
+
+    /** @brief Get an attribute by its position in name order.
+     *
+     *  @param[in] index - position, less than size()
+     */
+    Attribute attribute(size_t index) const;
+
+    /** @brief Decode the whole table. */
+    BaseTable table() const;
+
+    /** @brief Encode a copy of the image with some attributes replaced.
+     *
+     *  The rows of the unchanged attributes are copied column by column and
+     *  keep their string references, only the strings of the upserted
+     *  attributes are appended to the blob. Once the appended strings make
+     *  up half of the blob, the table is encoded again from scratch to drop
+     *  the strings no attribute refers to anymore.
+     *
+     *  @param[in] upserts - attributes to add or replace
+     *  @param[in] removals - names of attributes to remove, names the table
+     *                        does not have are ignored. A name that is also
+     *                        upserted is removed.
+     *  @param[out] patch - if not null, receives how the attribute IDs map
+     *
+     *  @return The new image. Throws std::length_error like build().
+     */
+    std::shared_ptr<const TableImage>
+        update(const BaseTable& upserts,
+               const std::vector<std::string>& removals,
+               Patch* patch = nullptr) const;
+
+    /** @brief Number of attributes in the table */
+    size_t size() const;
+
+    /** @brief The encoded image */
+    std::string_view data() const;
+
+    /** @brief CRC32C of the image contents, identifies the image.
+     *
+     *  An image built or updated in memory is checksummed on the first call
+     *  of this or data(), so a delta that is only journaled does not pay for
+     *  a pass over the whole image.
+     */
+    uint32_t checksum() const;
+
+    /** @brief Convert a value referring into the image into an owned one */
+    static Value toValue(const ValueView& value);
+
+  private:
+    class Encoder;
+
+    explicit TableImage(std::string data);
+    TableImage(void* mapping, size_t length);
+
+    void validate() const;
+    /** @brief Compute the checksum of an in-memory image and store it in
+     *         its header, once. Safe to call from any thread.
+     */
+    void seal() const;
+    /** @brief The header as read when the image was created, its crc field
+     *         is not filled in for an in-memory image
+     */
+    const image::Header& header() const
+    {
+        return head;
+    }
+    /** @brief Read element i of the column starting at offset */
+    template <typename T>
+    T column(uint64_t offset, size_t i) const;
+    std::string_view string(const image::StrRef& ref) const;
+    /** @brief Position of the first attribute from first on whose name is
+     *         not less than name
+     */
+    size_t lowerBound(std::string_view name, size_t first) const;
+    ValueView value(const image::Value& value) const;
+
+    /** @brief Bytes of an in-memory image, seal() writes the checksum */
+    mutable std::string owned;
+    void* mapping = nullptr;
+    size_t mappingLength = 0;
+    std::string_view bytes;
+    image::Header head;
+    /** @brief Column offsets, computed once the image is validated */
+    image::Layout columns{};
+    mutable std::once_flag sealed;
+    mutable uint32_t crc = 0;
+};
+
+} // namespace bios_config
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace bios_config
+{
+
+/** @class Worker
+ *
+ *  @brief Runs blocking jobs on a background thread, in the order they were
+ *         posted, and hands their completions back to the io loop.
+ *
+ *  The thread never touches the io context, completions are queued and the
+ *  io loop is woken through an eventfd. This keeps the io context single
+ *  threaded, so asio can still be built with BOOST_ASIO_DISABLE_THREADS.
+ */
+class Worker
+{
+  public:
+    using Job = std::function<void()>;
+    /** @brief Runs on the io loop, with the exception the job threw if any */
+    using Completion = std::function<void(std::exception_ptr)>;
+
+    Worker() = delete;
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+    Worker(Worker&&) = delete;
+    Worker& operator=(Worker&&) = delete;
+
+    /** @brief Constructs Worker object and starts its thread.
+     *
+     *  @param[in] io - io context the completions run on
+     */
+    explicit Worker(boost::asio::io_context& io);
+
+    /** @brief Finishes the queued jobs and stops the thread. Completions that
+     *         did not run yet are dropped.
+     */
+    ~Worker();
+
+    /** @brief Queue a job.
+     *
+     *  @param[in] job - work to run on the background thread
+     *  @param[in] done - completion to run on the io loop afterwards
+     */
+    void post(Job job, Completion done);
+
+    /** @brief Wait for every queued job and run the completions right away.
+     *         Meant for shutdown, when the io loop no longer runs.
+     */
+    void drain();
+
+  private:
+    void run();
+    void waitForCompletions();
+    void runCompletions();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<std::pair<Job, Completion>> jobs;
+    std::deque<std::pair<Completion, std::exception_ptr>> completions;
+    bool busy = false;
+    bool stopping = false;
+
+    boost::asio::posix::stream_descriptor event;
+    uint64_t eventCount = 0;
+    std::thread thread;
+};
+
+} // namespace bios_config
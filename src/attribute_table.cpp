@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "attribute_table.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+
+namespace bios_config
+{
+
+AttributeIndex::AttributeIndex(const TableImage& image) : image(&image)
+{
+    build();
+}
+
+void AttributeIndex::build()
+{
+    // At most half full, so probe sequences stay short
+    slots.assign(std::bit_ceil(std::max<size_t>(image->size() * 2, 1)),
+                 Slot{});
+    for (uint32_t id = 0; id < image->size(); id++)
+    {
+        insert(id);
+    }
+}
+
+void AttributeIndex::insert(uint32_t id)
+{
+    auto hash = std::hash<std::string_view>{}(name(id));
+    auto mask = slots.size() - 1;
+    auto pos = hash & mask;
+    while (slots[pos].id != emptySlot)
+    {
+        pos = (pos + 1) & mask;
+    }
+    slots[pos] = {static_cast<uint32_t>(hash), id};
+}
+
+void AttributeIndex::erase(std::string_view name, uint32_t id)
+{
+    auto mask = slots.size() - 1;
+    auto pos = std::hash<std::string_view>{}(name) & mask;
+    while (slots[pos].id != id)
+    {
+        pos = (pos + 1) & mask;
+    }
+
+    // Move the slots after it in the probe sequence back, unless that puts
+    // one before its home slot, so lookups need no tombstones
+    for (auto next = (pos + 1) & mask; slots[next].id != emptySlot;
+         next = (next + 1) & mask)
+    {
+        auto home = slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - pos) & mask))
+        {
+            slots[pos] = slots[next];
+            pos = next;
+        }
+    }
+    slots[pos] = {};
+}
+
+void AttributeIndex::update(const TableImage& updated,
+                            const TableImage& previous,
+                            const TableImage::Patch& patch,
+                            const std::vector<uint32_t>& renumbered)
+{
+    image = &updated;
+    if (!patch.renumbered)
+    {
+        // Same names with the same IDs
+        return;
+    }
+    if (updated.size() * 2 > slots.size())
+    {
+        build();
+        return;
+    }
+
+    for (auto id : patch.removed)
+    {
+        erase(previous.attribute(id).name(), id);
+    }
+    for (auto& slot : slots)
+    {
+        if (slot.id != emptySlot)
+        {
+            slot.id = renumbered[slot.id];
+        }
+    }
+    for (auto id : patch.upserted)
+    {
+        if (patch.previous[id] == TableImage::noId)
+        {
+            insert(id);
+        }
+    }
+}
+
+std::optional<uint32_t> AttributeIndex::find(std::string_view name) const
+{
+    auto hash = std::hash<std::string_view>{}(name);
+    auto mask = slots.size() - 1;
+    for (auto pos = hash & mask; slots[pos].id != emptySlot;
+         pos = (pos + 1) & mask)
+    {
+        const auto& slot = slots[pos];
+        if (slot.hash == static_cast<uint32_t>(hash) &&
+            this->name(slot.id) == name)
+        {
+            return slot.id;
+        }
+    }
+    return std::nullopt;
+}
+
+namespace
+{
+
+/** @brief Call a function for each menu name of a menu path */
+template <typename F>
+void forEachMenu(std::string_view path, F&& f)
+{
+    while (!path.empty())
+    {
+        auto end = path.find('/');
+        auto menu = path.substr(0, end);
+        if (!menu.empty() && menu != ".")
+        {
+            f(menu);
+        }
+        if (end == std::string_view::npos)
+        {
+            break;
+        }
+        path.remove_prefix(end + 1);
+    }
+}
+
+} // namespace
+
+MenuTree::MenuTree(const TableImage& image) : nodes(1)
+{
+    for (uint32_t id = 0; id < image.size(); id++)
+    {
+        add(image.attribute(id).menuPath(), id);
+    }
+}
+
+void MenuTree::add(std::string_view path, uint32_t id)
+{
+    uint32_t node = 0;
+    nodes[node].count++;
+    forEachMenu(path, [this, &node](std::string_view menu) {
+        auto& children = nodes[node].children;
+        auto it = children.find(menu);
+        if (it != children.end())
+        {
+            node = it->second;
+        }
+        else
+        {
+            auto child = static_cast<uint32_t>(nodes.size());
+            children.emplace(menu, child);
+            nodes.emplace_back();
+            node = child;
+        }
+        nodes[node].count++;
+    });
+    auto& attributes = nodes[node].attributes;
+    attributes.insert(std::ranges::lower_bound(attributes, id), id);
+}
+
+void MenuTree::remove(std::string_view path, uint32_t id)
+{
+    // The menus on the path, from the root down
+    std::vector<std::pair<std::string_view, uint32_t>> chain{{{}, 0}};
+    forEachMenu(path, [this, &chain](std::string_view menu) {
+        const auto& children = nodes[chain.back().second].children;
+        chain.emplace_back(menu, children.find(menu)->second);
+    });
+
+    auto& attributes = nodes[chain.back().second].attributes;
+    attributes.erase(std::ranges::lower_bound(attributes, id));
+    for (const auto& [menu, node] : chain)
+    {
+        nodes[node].count--;
+    }
+    for (auto i = chain.size() - 1; i > 0 && nodes[chain[i].second].count == 0;
+         i--)
+    {
+        nodes[chain[i - 1].second].children.erase(
+            nodes[chain[i - 1].second].children.find(chain[i].first));
+    }
+}
+
+void MenuTree::update(const TableImage& image, const TableImage& previous,
+                      const TableImage::Patch& patch,
+                      const std::vector<uint32_t>& renumbered)
+{
+    for (auto id : patch.removed)
+    {
+        remove(previous.attribute(id).menuPath(), id);
+    }
+
+    std::vector<uint32_t> added;
+    for (auto id : patch.upserted)
+    {
+        auto old = patch.previous[id];
+        if (old == TableImage::noId)
+        {
+            added.push_back(id);
+        }
+        else if (previous.attribute(old).menuPath() !=
+                 image.attribute(id).menuPath())
+        {
+            remove(previous.attribute(old).menuPath(), old);
+            added.push_back(id);
+        }
+    }
+
+    if (patch.renumbered)
+    {
+        // The mapping keeps the order, the lists stay sorted
+        for (auto& node : nodes)
+        {
+            for (auto& id : node.attributes)
+            {
+                id = renumbered[id];
+            }
+        }
+    }
+    for (auto id : added)
+    {
+        add(image.attribute(id).menuPath(), id);
+    }
+}
+
+const MenuTree::Node* MenuTree::find(std::string_view path) const
+{
+    const Node* node = &nodes.front();
+    forEachMenu(path, [this, &node](std::string_view menu) {
+        if (node == nullptr)
+        {
+            return;
+        }
+        auto it = node->children.find(menu);
+        node = it == node->children.end() ? nullptr : &nodes[it->second];
+    });
+    // Only the top level can be linked while empty, when the BaseBIOSTable
+    // is
+    if (node != nullptr && node->count == 0)
+    {
+        return nullptr;
+    }
+    return node;
+}
+
+AttributeTable::AttributeTable(std::shared_ptr<const TableImage> image,
+                               bool strict) :
+    table(std::move(image)), index(*table), menuTree(*table)
+{
+    validators.reserve(table->size());
+    for (size_t i = 0; i < table->size(); i++)
+    {
+        validators.push_back(compile(table->attribute(i), strict));
+    }
+}
+
+AttributeValidator AttributeTable::compile(const TableImage::Attribute& attr,
+                                           bool strict)
+{
+    try
+    {
+        return AttributeValidator::compile(attr);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        if (strict)
+        {
+            throw std::invalid_argument(std::string(attr.name()) + ": " +
+                                        e.what());
+        }
+        lg2::error(
+            "BIOS attribute {NAME} has malformed options, rejecting its values: {ERROR}",
+            "NAME", std::string(attr.name()), "ERROR", e);
+        return AttributeValidator::rejectAll(attr.type());
+    }
+}
+
+void AttributeTable::update(const TableImage::BaseTable& upserts,
+                            const std::vector<std::string>& removals,
+                            bool strict)
+{
+    TableImage::Patch patch;
+    auto updated = table->update(upserts, removals, &patch);
+
+    // Whatever can throw is done before the table is touched
+    std::vector<AttributeValidator> compiled;
+    compiled.reserve(patch.upserted.size());
+    for (auto id : patch.upserted)
+    {
+        compiled.push_back(compile(updated->attribute(id), strict));
+    }
+
+    std::vector<uint32_t> renumbered;
+    if (patch.renumbered)
+    {
+        renumbered.assign(table->size(), TableImage::noId);
+        for (uint32_t id = 0; id < patch.previous.size(); id++)
+        {
+            if (patch.previous[id] != TableImage::noId)
+            {
+                renumbered[patch.previous[id]] = id;
+            }
+        }
+    }
+
+    index.update(*updated, *table, patch, renumbered);
+    menuTree.update(*updated, *table, patch, renumbered);
+    if (patch.renumbered)
+    {
+        std::vector<AttributeValidator> moved;
+        moved.reserve(updated->size());
+        for (auto old : patch.previous)
+        {
+            // Added attributes get their compiled validator below
+            moved.push_back(old == TableImage::noId
+                                ? AttributeValidator::rejectAll(
+                                      TableImage::AttributeType::String)
+                                : std::move(validators[old]));
+        }
+        validators = std::move(moved);
+    }
+    for (size_t i = 0; i < patch.upserted.size(); i++)
+    {
+        validators[patch.upserted[i]] = std::move(compiled[i]);
+    }
+    table = std::move(updated);
+}
+
+void PendingStore::assign(const AttributeTable& table,
+                          const PendingAttributes& loaded)
+{
+    clear();
+    for (const auto& [name, value] : loaded)
+    {
+        if (auto id = table.find(name))
+        {
+            values.emplace(*id, value);
+        }
+        else
+        {
+            unindexed.emplace(name, value);
+        }
+    }
+}
+
+const PendingStore::PendingAttribute* PendingStore::find(uint32_t id) const
+{
+    auto it = values.find(id);
+    return it == values.end() ? nullptr : &it->second;
+}
+
+bool PendingStore::set(uint32_t id, const PendingAttribute& value)
+{
+    auto [it, inserted] = values.try_emplace(id, value);
+    if (!inserted)
+    {
+        if (it->second == value)
+        {
+            return false;
+        }
+        it->second = value;
+    }
+    return true;
+}
+
+std::vector<uint32_t> PendingStore::ids() const
+{
+    std::vector<uint32_t> result;
+    result.reserve(values.size());
+    for (const auto& [id, value] : values)
+    {
+        result.push_back(id);
+    }
+    return result;
+}
+
+void PendingStore::clear()
+{
+    values.clear();
+    unindexed.clear();
+}
+
+PendingStore::PendingAttributes
+    PendingStore::attributes(const AttributeTable& table) const
+{
+    auto result = unindexed;
+    for (const auto& [id, value] : values)
+    {
+        result.emplace(table.name(id), value);
+    }
+    return result;
+}
+
+} // namespace bios_config
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "attribute_validator.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace bios_config
+{
+
+using BoundType = TableImage::BoundType;
+
+/** @brief The integer value of an option, which must have one */
+static int64_t integerOption(const TableImage::Option& option)
+{
+    const auto* value = std::get_if<int64_t>(&option.value);
+    if (value == nullptr)
+    {
+        throw std::invalid_argument("bound is not an integer");
+    }
+    return *value;
+}
+
+/** @brief The string length bound of an option */
+static size_t lengthOption(const TableImage::Option& option)
+{
+    auto value = integerOption(option);
+    if (value < 0)
+    {
+        throw std::invalid_argument("string length bound is negative");
+    }
+    return static_cast<size_t>(value);
+}
+
+AttributeValidator
+    AttributeValidator::compile(const TableImage::Attribute& attr)
+{
+    AttributeValidator validator(attr.type());
+    // Only the options that apply to the type of the attribute are
+    // resolved, the others were never looked at.
+    for (const auto& option : attr.options())
+    {
+        switch (validator.attrType)
+        {
+            case AttributeType::Enumeration:
+                if (option.bound == BoundType::OneOf)
+                {
+                    const auto* value =
+                        std::get_if<std::string_view>(&option.value);
+                    if (value == nullptr)
+                    {
+                        throw std::invalid_argument(
+                            "OneOf value is not a string");
+                    }
+                    validator.oneOf.emplace(*value);
+                }
+                break;
+            case AttributeType::String:
+                if (option.bound == BoundType::MinStringLength)
+                {
+                    validator.minStringLength = lengthOption(option);
+                }
+                else if (option.bound == BoundType::MaxStringLength)
+                {
+                    validator.maxStringLength = lengthOption(option);
+                }
+                break;
+            case AttributeType::Integer:
+                if (option.bound == BoundType::LowerBound)
+                {
+                    validator.lowerBound = integerOption(option);
+                }
+                else if (option.bound == BoundType::UpperBound)
+                {
+                    validator.upperBound = integerOption(option);
+                }
+                else if (option.bound == BoundType::ScalarIncrement)
+                {
+                    validator.scalarIncrement = integerOption(option);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return validator;
+}
+
+AttributeValidator AttributeValidator::rejectAll(AttributeType type)
+{
+    AttributeValidator validator(type);
+    validator.malformed = true;
+    return validator;
+}
+
+bool AttributeValidator::validate(const Value& value) const
+{
+    if (malformed)
+    {
+        lg2::error("BIOS attribute has malformed options in the BaseBIOSTable");
+        return false;
+    }
+
+    switch (attrType)
+    {
+        case AttributeType::Enumeration:
+        {
+            const auto* attrValue = std::get_if<std::string>(&value);
+            if (attrValue == nullptr)
+            {
+                lg2::error("Enumeration property value is not enum");
+                return false;
+            }
+            if (!oneOf.contains(*attrValue))
+            {
+                lg2::error("No valid attribute");
+                return false;
+            }
+            return true;
+        }
+        case AttributeType::String:
+        {
+            const auto* attrValue = std::get_if<std::string>(&value);
+            if (attrValue == nullptr)
+            {
+                lg2::error("String property value is not string");
+                return false;
+            }
+            if (attrValue->length() < minStringLength ||
+                attrValue->length() > maxStringLength)
+            {
+                lg2::error(
+                    "{ATTRVALUE} Length is out of range, bound is invalid, maxStringLength = {MAXLEN}, minStringLength = {MINLEN}",
+                    "ATTRVALUE", *attrValue, "MAXLEN", maxStringLength,
+                    "MINLEN", minStringLength);
+                return false;
+            }
+            return true;
+        }
+        case AttributeType::Integer:
+        {
+            const auto* attrValue = std::get_if<int64_t>(&value);
+            if (attrValue == nullptr)
+            {
+                lg2::error("Integer property value is not int");
+                return false;
+            }
+            if ((*attrValue < lowerBound) || (*attrValue > upperBound))
+            {
+                lg2::error("Integer, bound is invalid");
+                return false;
+            }
+            if (scalarIncrement == 0 ||
+                ((std::abs(*attrValue - lowerBound)) % scalarIncrement) != 0)
+            {
+                lg2::error(
+                    "((std::abs({ATTR_VALUE} - {LOWER_BOUND})) % {SCALAR_INCREMENT}) != 0",
+                    "ATTR_VALUE", *attrValue, "LOWER_BOUND", lowerBound,
+                    "SCALAR_INCREMENT", scalarIncrement);
+                return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+} // namespace bios_config
@@ -0,0 +1,627 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Offline inspection of the persisted files of the BIOS config manager. Links
+// the persistence code only, so it runs on a copy of the files without the
+// service or a D-Bus connection.
+
+#include "attribute_table.hpp"
+#include "manager_serialize.hpp"
+#include "table_image.hpp"
+
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+using namespace bios_config;
+using ManagerServer = sdbusplus::xyz::openbmc_project::BIOSConfig::server::
+    Manager;
+using SecureBootServer = sdbusplus::xyz::openbmc_project::BIOSConfig::server::
+    SecureBoot;
+
+constexpr int exitProblems = 1;
+constexpr int exitUsage = 2;
+
+void usage()
+{
+    std::cerr
+        << "Usage: biosdata-tool <command> <path> [arguments]\n"
+           "\n"
+           "<path> is the base path of the persisted files, for example\n"
+           "/var/lib/bios-settings-manager/biosData. Sections, the journal\n"
+           "and the whole-state file of earlier releases are all found\n"
+           "from it.\n"
+           "\n"
+           "Commands:\n"
+           "  dump <path>              Print the state as JSON\n"
+           "  validate <path>          Check every slot, table image and\n"
+           "                           journal record, exit 1 on problems\n"
+           "  convert <path> <out> [--to sections|legacy-v1|legacy-v2|\n"
+           "          legacy-v3]       Write the state in another format,\n"
+           "                           sections by default\n"
+           "  time <path> [count]      Time loading and saving the state\n"
+           "  bench-lookup [path]      Compare GetAttribute lookups through\n"
+           "                           the attribute index with copying the\n"
+           "                           whole table, on a generated table of\n"
+           "                           5000 attributes without a path\n"
+           "  bench-update [path]      Compare applying a one attribute\n"
+           "                           BaseBIOSTable delta by patching with\n"
+           "                           rebuilding the table, on the same\n"
+           "                           generated table without a path\n";
+}
+
+nlohmann::json toJson(const std::variant<int64_t, std::string>& value)
+{
+    return std::visit([](const auto& v) { return nlohmann::json(v); },
+                      value);
+}
+
+nlohmann::json toJson(const journal::BootOptionValue& value)
+{
+    return std::visit([](const auto& v) { return nlohmann::json(v); },
+                      value);
+}
+
+nlohmann::json toJson(const Snapshot& state)
+{
+    auto table = nlohmann::json::object();
+    for (const auto& [name, attr] : state.baseTable->table())
+    {
+        const auto& [type, readOnly, displayName, description, menuPath,
+                     current, defaultValue, options] = attr;
+        auto bounds = nlohmann::json::array();
+        for (const auto& [bound, value, valueDescription] : options)
+        {
+            bounds.push_back(
+                {{"BoundType", ManagerServer::convertBoundTypeToString(bound)},
+                 {"Value", toJson(value)},
+                 {"ValueDescription", valueDescription}});
+        }
+        table[name] = {
+            {"AttributeType",
+             ManagerServer::convertAttributeTypeToString(type)},
+            {"ReadOnly", readOnly},
+            {"DisplayName", displayName},
+            {"Description", description},
+            {"MenuPath", menuPath},
+            {"CurrentValue", toJson(current)},
+            {"DefaultValue", toJson(defaultValue)},
+            {"Options", std::move(bounds)}};
+    }
+
+    auto pending = nlohmann::json::object();
+    for (const auto& [name, attr] : state.pendingAttributes)
+    {
+        const auto& [type, value] = attr;
+        pending[name] = {
+            {"AttributeType",
+             ManagerServer::convertAttributeTypeToString(type)},
+            {"Value", toJson(value)}};
+    }
+
+    auto bootOptions = nlohmann::json::object();
+    for (const auto& [key, values] : state.bootOptions)
+    {
+        auto properties = nlohmann::json::object();
+        for (const auto& [property, value] : values)
+        {
+            properties[property] = toJson(value);
+        }
+        bootOptions[key] = std::move(properties);
+    }
+
+    auto generation = [&state](Generation part) {
+        return state.generations[static_cast<size_t>(part)];
+    };
+
+    return {
+        {"BaseBIOSTable", std::move(table)},
+        {"PendingAttributes", std::move(pending)},
+        {"EnableAfterReset", state.enableAfterReset},
+        {"CredentialBootstrap", state.credentialBootstrap},
+        {"BootOrder", state.bootOrder},
+        {"PendingBootOrder", state.pendingBootOrder},
+        {"BootOptions", std::move(bootOptions)},
+        {"CurrentBoot",
+         SecureBootServer::convertCurrentBootTypeToString(state.currentBoot)},
+        {"Enable", state.enable},
+        {"Mode", SecureBootServer::convertModeTypeToString(state.mode)},
+        {"Generations",
+         {{"BaseBIOSTable", generation(Generation::baseTable)},
+          {"PendingAttributes", generation(Generation::pendingAttributes)},
+          {"Boot", generation(Generation::boot)},
+          {"SecureBoot", generation(Generation::secureBoot)}}}};
+}
+
+/** @brief Load the state without modifying the files. */
+bool load(const fs::path& path, Snapshot& state)
+{
+    // The sections that are not persisted keep the defaults
+    state.baseTable = TableImage::build({});
+    Persistence persistence(path, false);
+    if (!persistence.load(state))
+    {
+        std::cerr << "No Bios Config found at " << path.string() << "\n";
+        return false;
+    }
+    return true;
+}
+
+int dump(const fs::path& path)
+{
+    Snapshot state;
+    if (!load(path, state))
+    {
+        return exitProblems;
+    }
+    std::cout << toJson(state).dump(4) << "\n";
+    return EXIT_SUCCESS;
+}
+
+int validate(const fs::path& path)
+{
+    Persistence persistence(path, false);
+    auto problems = persistence.verify();
+    for (const auto& problem : problems)
+    {
+        std::cout << problem << "\n";
+    }
+    if (!problems.empty())
+    {
+        return exitProblems;
+    }
+    std::cout << "OK\n";
+    return EXIT_SUCCESS;
+}
+
+int convert(const fs::path& path, const fs::path& out, std::string_view to)
+{
+    Snapshot state;
+    if (!load(path, state))
+    {
+        return exitProblems;
+    }
+
+    if (out.has_parent_path())
+    {
+        fs::create_directories(out.parent_path());
+    }
+    if (to == "sections")
+    {
+        Persistence(out).save(state);
+    }
+    else if (to == "legacy-v1")
+    {
+        saveLegacy(out, state, 1);
+    }
+    else if (to == "legacy-v2")
+    {
+        saveLegacy(out, state, 2);
+    }
+    else if (to == "legacy-v3")
+    {
+        saveLegacy(out, state, 3);
+    }
+    else
+    {
+        usage();
+        return exitUsage;
+    }
+    return EXIT_SUCCESS;
+}
+
+void report(std::string_view what, std::vector<std::chrono::microseconds>& t)
+{
+    std::ranges::sort(t);
+    std::cout << what << ": min " << t.front().count() << " us, median "
+              << t[t.size() / 2].count() << " us, max " << t.back().count()
+              << " us\n";
+}
+
+/** @brief Bytes of the image strings that refer to an earlier copy of an
+ *         equal string instead of storing their own.
+ */
+size_t sharedStringBytes(const TableImage& image)
+{
+    std::unordered_set<std::string_view> distinct;
+    size_t referenced = 0;
+    size_t stored = 0;
+    auto add = [&](std::string_view str) {
+        referenced += str.size();
+        if (distinct.insert(str).second)
+        {
+            stored += str.size();
+        }
+    };
+    auto addValue = [&](const TableImage::ValueView& value) {
+        if (const auto* str = std::get_if<std::string_view>(&value))
+        {
+            add(*str);
+        }
+    };
+
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        auto attribute = image.attribute(i);
+        add(attribute.name());
+        add(attribute.displayName());
+        add(attribute.description());
+        add(attribute.menuPath());
+        addValue(attribute.currentValue());
+        addValue(attribute.defaultValue());
+        for (const auto& option : attribute.options())
+        {
+            addValue(option.value);
+            add(option.description);
+        }
+    }
+    return referenced - stored;
+}
+
+/** @brief Resident set size of this process in kB, 0 if unknown */
+long residentKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.starts_with("VmRSS:"))
+        {
+            return std::atol(line.c_str() + std::strlen("VmRSS:"));
+        }
+    }
+    return 0;
+}
+
+int timeLoadSave(const fs::path& path, int count)
+{
+    using clock = std::chrono::steady_clock;
+    auto residentBefore = residentKb();
+    Snapshot state;
+    std::vector<std::chrono::microseconds> loads;
+    for (int i = 0; i < count; i++)
+    {
+        Snapshot loaded;
+        auto start = clock::now();
+        if (!load(path, loaded))
+        {
+            return exitProblems;
+        }
+        loads.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+            clock::now() - start));
+        state = std::move(loaded);
+    }
+    auto residentLoaded = residentKb();
+
+    // Every save writes all sections, like the migration on first start
+    auto dir = fs::temp_directory_path() /
+               ("biosdata-tool." + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    std::vector<std::chrono::microseconds> saves;
+    try
+    {
+        for (int i = 0; i < count; i++)
+        {
+            auto start = clock::now();
+            Persistence(dir / "biosData").save(state);
+            saves.push_back(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    clock::now() - start));
+        }
+    }
+    catch (...)
+    {
+        fs::remove_all(dir);
+        throw;
+    }
+    fs::remove_all(dir);
+
+    std::cout << "Attributes: " << state.baseTable->size()
+              << ", table image: " << state.baseTable->data().size()
+              << " bytes, " << sharedStringBytes(*state.baseTable)
+              << " bytes of repeated strings shared\n"
+              << "Resident: " << residentBefore << " kB before loading, "
+              << residentLoaded << " kB with the state loaded\n";
+    report("load", loads);
+    report("save", saves);
+    return EXIT_SUCCESS;
+}
+
+/** @brief A table shaped like the ones hosts send, long names and a few
+ *         menu paths and enum labels shared by most attributes.
+ */
+Snapshot generateState(size_t count)
+{
+    using AttributeType = TableImage::AttributeType;
+    using BoundType = TableImage::BoundType;
+    TableImage::BaseTable table;
+    for (size_t i = 0; i < count; i++)
+    {
+        auto name = "PlatformConfigurationAttribute" + std::to_string(i);
+        auto menuPath = "Advanced/Platform Configuration/Group " +
+                        std::to_string(i % 20);
+        if (i % 2 == 0)
+        {
+            table.emplace(
+                name, std::make_tuple(
+                          AttributeType::Enumeration, false, name,
+                          "Enables or disables " + name, menuPath,
+                          std::string("Enabled"), std::string("Disabled"),
+                          std::vector<std::tuple<BoundType, TableImage::Value,
+                                                 std::string>>{
+                              {BoundType::OneOf, std::string("Enabled"), ""},
+                              {BoundType::OneOf, std::string("Disabled"),
+                               ""}}));
+        }
+        else
+        {
+            table.emplace(
+                name, std::make_tuple(
+                          AttributeType::Integer, false, name,
+                          "Sets " + name, menuPath, int64_t{1}, int64_t{1},
+                          std::vector<std::tuple<BoundType, TableImage::Value,
+                                                 std::string>>{
+                              {BoundType::LowerBound, int64_t{0}, ""},
+                              {BoundType::UpperBound, int64_t{255}, ""},
+                              {BoundType::ScalarIncrement, int64_t{1}, ""}}));
+        }
+    }
+
+    Snapshot state;
+    state.baseTable = TableImage::build(table);
+    for (size_t i = 1; i < count; i += 50)
+    {
+        state.pendingAttributes.emplace(
+            "PlatformConfigurationAttribute" + std::to_string(i),
+            std::make_tuple(AttributeType::Integer,
+                            std::variant<int64_t, std::string>(int64_t{2})));
+    }
+    return state;
+}
+
+int benchLookup(const Snapshot& state)
+{
+    using clock = std::chrono::steady_clock;
+    AttributeTable attributes(state.baseTable, false);
+    PendingStore pending;
+    pending.assign(attributes, state.pendingAttributes);
+    std::vector<std::string> names;
+    for (uint32_t id = 0; id < state.baseTable->size(); id++)
+    {
+        names.emplace_back(attributes.name(id));
+    }
+    if (names.empty())
+    {
+        std::cerr << "The BaseBIOSTable is empty\n";
+        return exitProblems;
+    }
+
+    // Keeps the lookups from being optimized away
+    size_t found = 0;
+
+    // What GetAttribute used to do: copy the table and the pending map,
+    // then look the attribute up in both.
+    constexpr size_t copyRounds = 20;
+    auto start = clock::now();
+    for (size_t i = 0; i < copyRounds; i++)
+    {
+        const auto& name = names[i * 7919 % names.size()];
+        auto table = state.baseTable->table();
+        auto pendingAttrs = state.pendingAttributes;
+        found += table.contains(name) + pendingAttrs.contains(name);
+    }
+    auto copyTime = clock::now() - start;
+
+    constexpr size_t indexRounds = 1000000;
+    start = clock::now();
+    for (size_t i = 0; i < indexRounds; i++)
+    {
+        const auto& name = names[i * 7919 % names.size()];
+        auto id = attributes.find(name);
+        auto value = TableImage::toValue(
+            attributes.attribute(*id).currentValue());
+        found += value.index() + (pending.find(*id) != nullptr);
+    }
+    auto indexTime = clock::now() - start;
+
+    std::cout
+        << "Attributes: " << names.size()
+        << ", pending: " << state.pendingAttributes.size() << "\n"
+        << "Copying the table: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(copyTime)
+                   .count() /
+               copyRounds
+        << " ns per lookup\n"
+        << "Attribute index: "
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(indexTime)
+                   .count() /
+               indexRounds
+        << " ns per lookup\n";
+    return found != 0 ? EXIT_SUCCESS : exitProblems;
+}
+
+} // namespace
+
+int benchUpdate(const Snapshot& state)
+{
+    using clock = std::chrono::steady_clock;
+    AttributeTable attributes(state.baseTable, false);
+    if (state.baseTable->size() == 0)
+    {
+        std::cerr << "The BaseBIOSTable is empty\n";
+        return exitProblems;
+    }
+
+    // Each round changes the current value of one attribute, and adds one
+    // attribute and removes it again, like hosts report a changed setting
+    // and a hot-plugged device
+    auto delta = [&state](size_t i) {
+        auto id = i * 7919 % state.baseTable->size();
+        auto attr = state.baseTable->attribute(id);
+        auto entry = attr.decode();
+        auto& current = std::get<5>(entry);
+        if (auto* integer = std::get_if<int64_t>(&current))
+        {
+            *integer += static_cast<int64_t>(i % 2);
+        }
+        TableImage::BaseTable upserts;
+        upserts.emplace(attr.name(), entry);
+        if (i % 2 == 0)
+        {
+            upserts.emplace("BenchmarkAddedAttribute", entry);
+            return std::make_pair(upserts, std::vector<std::string>{});
+        }
+        return std::make_pair(
+            upserts, std::vector<std::string>{"BenchmarkAddedAttribute"});
+    };
+
+    // What updateBaseBIOSTable used to do: decode, merge, encode and compile
+    // the whole table
+    constexpr size_t rebuildRounds = 20;
+    auto rebuilt = attributes.image();
+    auto start = clock::now();
+    for (size_t i = 0; i < rebuildRounds; i++)
+    {
+        auto [upserts, removals] = delta(i);
+        auto table = rebuilt->table();
+        for (auto& [name, attr] : upserts)
+        {
+            table.insert_or_assign(name, std::move(attr));
+        }
+        for (const auto& name : removals)
+        {
+            table.erase(name);
+        }
+        AttributeTable compiled(TableImage::build(table), false);
+        rebuilt = compiled.image();
+    }
+    auto rebuildTime = clock::now() - start;
+
+    constexpr size_t patchRounds = 1000;
+    start = clock::now();
+    for (size_t i = 0; i < patchRounds; i++)
+    {
+        auto [upserts, removals] = delta(i);
+        attributes.update(upserts, removals, false);
+    }
+    auto patchTime = clock::now() - start;
+
+    std::cout
+        << "Attributes: " << state.baseTable->size() << "\n"
+        << "Rebuilding the table: "
+        << std::chrono::duration_cast<std::chrono::microseconds>(rebuildTime)
+                   .count() /
+               rebuildRounds
+        << " us per delta\n"
+        << "Patching the table: "
+        << std::chrono::duration_cast<std::chrono::microseconds>(patchTime)
+                   .count() /
+               patchRounds
+        << " us per delta\n";
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    std::span<char*> args(argv, argc);
+    if (args.size() == 2 && std::string_view(args[1]) == "bench-lookup")
+    {
+        return benchLookup(generateState(5000));
+    }
+    if (args.size() == 2 && std::string_view(args[1]) == "bench-update")
+    {
+        return benchUpdate(generateState(5000));
+    }
+    if (args.size() < 3)
+    {
+        usage();
+        return exitUsage;
+    }
+
+    std::string_view command = args[1];
+    fs::path path = args[2];
+    try
+    {
+        if (command == "bench-lookup" && args.size() == 3)
+        {
+            Snapshot state;
+            if (!load(path, state))
+            {
+                return exitProblems;
+            }
+            return benchLookup(state);
+        }
+        if (command == "bench-update" && args.size() == 3)
+        {
+            Snapshot state;
+            if (!load(path, state))
+            {
+                return exitProblems;
+            }
+            return benchUpdate(state);
+        }
+        if (command == "dump" && args.size() == 3)
+        {
+            return dump(path);
+        }
+        if (command == "validate" && args.size() == 3)
+        {
+            return validate(path);
+        }
+        if (command == "convert" && args.size() == 4)
+        {
+            return convert(path, args[3], "sections");
+        }
+        if (command == "convert" && args.size() == 6 &&
+            std::string_view(args[4]) == "--to")
+        {
+            return convert(path, args[3], args[5]);
+        }
+        if (command == "time" && args.size() <= 4)
+        {
+            int count = args.size() == 4 ? std::atoi(args[3]) : 10;
+            if (count > 0)
+            {
+                return timeLoadSave(path, count);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << command << " failed: " << e.what() << "\n";
+        return exitProblems;
+    }
+
+    usage();
+    return exitUsage;
+}
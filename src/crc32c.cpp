@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "crc32c.hpp"
+
+#include <array>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+
+#include <cstring>
+#endif
+
+namespace bios_config
+{
+
+namespace
+{
+
+constexpr uint32_t polynomial = 0x82f63b78; // reversed Castagnoli
+
+constexpr std::array<uint32_t, 256> makeTable()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            c = (c & 1) ? (polynomial ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr auto crcTable = makeTable();
+
+} // namespace
+
+uint32_t crc32c(std::string_view data, uint32_t crc)
+{
+    crc = ~crc;
+    const auto* p = reinterpret_cast<const uint8_t*>(data.data());
+    size_t len = data.size();
+
+#if defined(__ARM_FEATURE_CRC32)
+    // ARMv8 BMC SoCs implement CRC32C in hardware, 8 bytes per instruction
+    while (len >= sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += sizeof(word);
+        len -= sizeof(word);
+    }
+#endif
+
+    while (len-- > 0)
+    {
+        crc = crcTable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace bios_config
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "event_limiter.hpp"
+
+#include <algorithm>
+#include <ratio>
+#include <utility>
+
+namespace bios_config
+{
+
+using Minutes = std::chrono::duration<double, std::ratio<60>>;
+
+EventLimiter::EventLimiter(Clock::time_point now, double burst,
+                           double ratePerMinute) :
+    interval(std::chrono::round<Clock::duration>(Minutes(1) / ratePerMinute)),
+    capacity(std::chrono::round<Clock::duration>(interval * burst)),
+    credit(capacity), refilled(now)
+{}
+
+void EventLimiter::refill(Clock::time_point now)
+{
+    credit = std::min(capacity, credit + (now - refilled));
+    refilled = now;
+}
+
+EventLimiter::Verdict EventLimiter::offer(const std::string& value,
+                                          bool suppressRepeats,
+                                          Clock::time_point now)
+{
+    this->suppressRepeats = suppressRepeats;
+    if (suppressRepeats && lastValue == value)
+    {
+        // The log already shows this value, a held back one is outdated
+        trailing.reset();
+        return Verdict::repeat;
+    }
+
+    refill(now);
+    if (credit < interval)
+    {
+        suppressed++;
+        trailing = value;
+        return Verdict::limited;
+    }
+    return Verdict::send;
+}
+
+void EventLimiter::hold(const std::string& value)
+{
+    trailing = value;
+}
+
+uint64_t EventLimiter::sent(const std::string& value)
+{
+    credit -= interval;
+    lastValue = value;
+    trailing.reset();
+    return std::exchange(suppressed, 0);
+}
+
+std::optional<std::string> EventLimiter::dueTrailing(Clock::time_point now)
+{
+    if (!trailing)
+    {
+        return std::nullopt;
+    }
+    if (suppressRepeats && trailing == lastValue)
+    {
+        trailing.reset();
+        return std::nullopt;
+    }
+
+    refill(now);
+    if (credit < interval)
+    {
+        return std::nullopt;
+    }
+    return trailing;
+}
+
+std::optional<EventLimiter::Clock::time_point>
+    EventLimiter::trailingDue() const
+{
+    if (!trailing)
+    {
+        return std::nullopt;
+    }
+    // A value held back by the queue cap is due right away
+    return refilled + std::max(Clock::duration::zero(), interval - credit);
+}
+
+} // namespace bios_config
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "journal.hpp"
+
+#include "crc32c.hpp"
+#include "persist_file.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace bios_config
+{
+
+namespace
+{
+
+constexpr uint32_t journalMagic = 0x4c4e4a42; // "BJNL"
+// The header holds the sequence number of the first record, persisted
+// sections record which sequence numbers they cover.
+constexpr uint32_t journalVersion = 1;
+
+/** @brief On-disk journal header, stored in host byte order */
+struct JournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t base;
+    /** @brief CRC32C over all preceding header fields */
+    uint32_t headerCrc;
+    uint32_t reserved;
+};
+static_assert(sizeof(JournalHeader) == 24);
+
+/** @brief Framing in front of every record payload */
+struct RecordHeader
+{
+    uint32_t length;
+    uint32_t crc;
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+uint32_t headerChecksum(const JournalHeader& header)
+{
+    return crc32c(std::string_view(reinterpret_cast<const char*>(&header),
+                                   offsetof(JournalHeader, headerCrc)));
+}
+
+} // namespace
+
+std::optional<JournalContents> readJournal(const fs::path& path, bool repair)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    if (!is.is_open())
+    {
+        return std::nullopt;
+    }
+
+    std::string data{std::istreambuf_iterator<char>(is),
+                     std::istreambuf_iterator<char>()};
+    JournalHeader header{};
+    if (data.size() < sizeof(header))
+    {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != journalMagic ||
+        header.version != journalVersion ||
+        header.headerCrc != headerChecksum(header))
+    {
+        lg2::error("Journal {PATH} has an invalid header", "PATH",
+                   path.string());
+        return std::nullopt;
+    }
+
+    std::vector<std::string> records;
+    size_t offset = sizeof(header);
+    while (data.size() - offset >= sizeof(RecordHeader))
+    {
+        RecordHeader record;
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        std::string_view payload(data);
+        payload = payload.substr(offset + sizeof(record));
+        if (payload.size() < record.length)
+        {
+            break;
+        }
+        payload = payload.substr(0, record.length);
+        if (crc32c(payload) != record.crc)
+        {
+            break;
+        }
+        records.emplace_back(payload);
+        offset += sizeof(record) + record.length;
+    }
+
+    if (offset != data.size() && repair)
+    {
+        lg2::error("Dropping {SIZE} bytes of torn records from journal {PATH}",
+                   "SIZE", data.size() - offset, "PATH", path.string());
+        if (::truncate(path.c_str(), offset) < 0)
+        {
+            lg2::error("Failed to truncate journal {PATH}: {ERRNO}", "PATH",
+                       path.string(), "ERRNO", errno);
+        }
+    }
+
+    return JournalContents{header.base, std::move(records), offset};
+}
+
+size_t appendJournal(const fs::path& path,
+                     const std::vector<std::string>& records)
+{
+    std::string buffer;
+    for (const auto& payload : records)
+    {
+        RecordHeader record{static_cast<uint32_t>(payload.size()),
+                            crc32c(payload)};
+        buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        buffer.append(payload);
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "open " + path.string());
+    }
+
+    std::string_view remaining(buffer);
+    struct stat st{};
+    int rc = 0;
+    while (!remaining.empty())
+    {
+        auto written = ::write(fd, remaining.data(), remaining.size());
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            rc = -1;
+            break;
+        }
+        remaining.remove_prefix(written);
+    }
+    if (rc == 0)
+    {
+        rc = ::fdatasync(fd);
+    }
+    if (rc == 0)
+    {
+        rc = ::fstat(fd, &st);
+    }
+    int err = errno;
+    ::close(fd);
+    if (rc < 0)
+    {
+        throw std::system_error(err, std::generic_category(),
+                                "append " + path.string());
+    }
+
+    return st.st_size;
+}
+
+size_t resetJournal(const fs::path& path, uint64_t firstSeq)
+{
+    JournalHeader header{};
+    header.magic = journalMagic;
+    header.version = journalVersion;
+    header.base = firstSeq;
+    header.headerCrc = headerChecksum(header);
+
+    writeFileAtomic(path,
+                    std::string_view(reinterpret_cast<const char*>(&header),
+                                     sizeof(header)));
+    return sizeof(header);
+}
+
+} // namespace bios_config
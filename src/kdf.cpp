@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kdf.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+#include <openssl/core_names.h>
+#include <openssl/kdf.h>
+#include <openssl/params.h>
+#endif
+
+#include <stdexcept>
+#include <string>
+
+namespace bios_config_pwd::kdf
+{
+
+namespace
+{
+
+const EVP_MD* digest(Algorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case Algorithm::pbkdf2Sha256:
+            return EVP_sha256();
+        case Algorithm::pbkdf2Sha384:
+            return EVP_sha384();
+        case Algorithm::pbkdf2Sha512:
+            return EVP_sha512();
+        default:
+            return nullptr;
+    }
+}
+
+void pbkdf2(const Params& params, std::span<const uint8_t> password,
+            std::span<const uint8_t> salt, std::span<uint8_t> out)
+{
+    if (!PKCS5_PBKDF2_HMAC(reinterpret_cast<const char*>(password.data()),
+                           password.size(), salt.data(), salt.size(),
+                           params.iterations, digest(params.algorithm),
+                           out.size(), out.data()))
+    {
+        throw std::runtime_error("PKCS5_PBKDF2_HMAC failed");
+    }
+}
+
+void scrypt(const Params& params, std::span<const uint8_t> password,
+            std::span<const uint8_t> salt, std::span<uint8_t> out)
+{
+    if (params.iterations < 2 ||
+        (params.iterations & (params.iterations - 1)) != 0)
+    {
+        throw std::invalid_argument("scrypt N must be a power of 2");
+    }
+    if (!EVP_PBE_scrypt(reinterpret_cast<const char*>(password.data()),
+                        password.size(), salt.data(), salt.size(),
+                        params.iterations, params.blockSize,
+                        params.parallelism,
+                        static_cast<uint64_t>(params.memoryKiB) * 1024,
+                        out.data(), out.size()))
+    {
+        throw std::runtime_error("EVP_PBE_scrypt failed");
+    }
+}
+
+void argon2id([[maybe_unused]] const Params& params,
+              [[maybe_unused]] std::span<const uint8_t> password,
+              [[maybe_unused]] std::span<const uint8_t> salt,
+              [[maybe_unused]] std::span<uint8_t> out)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+    EVP_KDF* kdf = EVP_KDF_fetch(nullptr, "ARGON2ID", nullptr);
+    if (kdf == nullptr)
+    {
+        throw std::runtime_error("OpenSSL does not provide ARGON2ID");
+    }
+    EVP_KDF_CTX* ctx = EVP_KDF_CTX_new(kdf);
+    EVP_KDF_free(kdf);
+    if (ctx == nullptr)
+    {
+        throw std::runtime_error("EVP_KDF_CTX_new failed");
+    }
+
+    uint32_t iterations = params.iterations;
+    uint32_t memoryKiB = params.memoryKiB;
+    uint32_t lanes = params.parallelism;
+    // Lanes are computed one after the other, the worker is one thread
+    uint32_t threads = 1;
+    std::array<OSSL_PARAM, 7> osslParams = {
+        OSSL_PARAM_construct_octet_string(
+            OSSL_KDF_PARAM_PASSWORD,
+            const_cast<uint8_t*>(password.data()), password.size()),
+        OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_SALT,
+                                          const_cast<uint8_t*>(salt.data()),
+                                          salt.size()),
+        OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ITER, &iterations),
+        OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_MEMCOST,
+                                    &memoryKiB),
+        OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_ARGON2_LANES, &lanes),
+        OSSL_PARAM_construct_uint32(OSSL_KDF_PARAM_THREADS, &threads),
+        OSSL_PARAM_construct_end()};
+    int rc = EVP_KDF_derive(ctx, out.data(), out.size(), osslParams.data());
+    EVP_KDF_CTX_free(ctx);
+    if (rc != 1)
+    {
+        throw std::runtime_error("ARGON2ID derivation failed");
+    }
+#else
+    throw std::runtime_error("ARGON2ID needs OpenSSL 3.2 or later");
+#endif
+}
+
+} // namespace
+
+std::optional<Algorithm> parseAlgorithm(std::string_view name)
+{
+    for (auto algorithm : algorithms)
+    {
+        if (algorithmName(algorithm) == name)
+        {
+            return algorithm;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view algorithmName(Algorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case Algorithm::pbkdf2Sha256:
+            return "SHA256";
+        case Algorithm::pbkdf2Sha384:
+            return "SHA384";
+        case Algorithm::pbkdf2Sha512:
+            return "SHA512";
+        case Algorithm::scrypt:
+            return "SCRYPT";
+        case Algorithm::argon2id:
+            return "ARGON2ID";
+    }
+    return "";
+}
+
+Params defaults(Algorithm algorithm)
+{
+    switch (algorithm)
+    {
+        case Algorithm::pbkdf2Sha256:
+            return {algorithm, defaultPbkdf2Iterations, 0, 0, 0, 32};
+        case Algorithm::pbkdf2Sha384:
+            return {algorithm, defaultPbkdf2Iterations, 0, 0, 0, 48};
+        case Algorithm::pbkdf2Sha512:
+            return {algorithm, defaultPbkdf2Iterations, 0, 0, 0, 64};
+        case Algorithm::scrypt:
+            // N = 2^14, r = 8 uses 16 MiB
+            return {algorithm, 16384, 32768, 8, 1, 32};
+        case Algorithm::argon2id:
+            return {algorithm, 2, 19456, 0, 1, 32};
+    }
+    return {algorithm, 0, 0, 0, 0, 0};
+}
+
+bool available(Algorithm algorithm)
+{
+    if (algorithm != Algorithm::argon2id)
+    {
+        return true;
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30200000L
+    EVP_KDF* kdf = EVP_KDF_fetch(nullptr, "ARGON2ID", nullptr);
+    EVP_KDF_free(kdf);
+    return kdf != nullptr;
+#else
+    return false;
+#endif
+}
+
+void derive(const Params& params, std::span<const uint8_t> password,
+            std::span<const uint8_t> salt, std::span<uint8_t> out)
+{
+    if (params.iterations == 0 || params.length == 0 ||
+        out.size() != params.length)
+    {
+        throw std::invalid_argument(
+            "Invalid " + std::string(algorithmName(params.algorithm)) +
+            " parameters");
+    }
+
+    switch (params.algorithm)
+    {
+        case Algorithm::pbkdf2Sha256:
+        case Algorithm::pbkdf2Sha384:
+        case Algorithm::pbkdf2Sha512:
+            pbkdf2(params, password, salt, out);
+            break;
+        case Algorithm::scrypt:
+            scrypt(params, password, salt, out);
+            break;
+        case Algorithm::argon2id:
+            argon2id(params, password, salt, out);
+            break;
+    }
+}
+
+} // namespace bios_config_pwd::kdf
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Password hashes per second of each KDF and work factor, to pick the HashAlgo
+// and work factor of a platform's seedData file. Runs each setting for 200 ms,
+// or the milliseconds given as the only argument.
+
+#include "kdf.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int benchKdf(std::chrono::milliseconds budget)
+{
+    namespace kdf = bios_config_pwd::kdf;
+    using clock = std::chrono::steady_clock;
+
+    struct Setting
+    {
+        kdf::Algorithm algorithm;
+        uint32_t iterations;
+        uint32_t memoryKiB;
+    };
+    // The defaults, stronger PBKDF2 counts and the memory hard KDFs at the
+    // minimum and default costs
+    constexpr std::array settings = {
+        Setting{kdf::Algorithm::pbkdf2Sha256, 1000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha256, 10000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha256, 100000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha384, 1000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha384, 10000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha384, 100000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha512, 1000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha512, 10000, 0},
+        Setting{kdf::Algorithm::pbkdf2Sha512, 100000, 0},
+        Setting{kdf::Algorithm::scrypt, 1024, 32768},
+        Setting{kdf::Algorithm::scrypt, 16384, 32768},
+        Setting{kdf::Algorithm::scrypt, 65536, 131072},
+        Setting{kdf::Algorithm::argon2id, 1, 19456},
+        Setting{kdf::Algorithm::argon2id, 2, 19456},
+        Setting{kdf::Algorithm::argon2id, 3, 65536},
+    };
+
+    const std::string password = "BenchmarkPassword";
+    std::array<uint8_t, 32> salt{};
+    for (size_t i = 0; i < salt.size(); i++)
+    {
+        salt[i] = i;
+    }
+
+    for (const auto& setting : settings)
+    {
+        auto name = kdf::algorithmName(setting.algorithm);
+        if (!kdf::available(setting.algorithm))
+        {
+            std::cout << name << " iterations " << setting.iterations
+                      << ": not provided by OpenSSL\n";
+            continue;
+        }
+
+        auto params = kdf::defaults(setting.algorithm);
+        params.iterations = setting.iterations;
+        if (setting.memoryKiB != 0)
+        {
+            params.memoryKiB = setting.memoryKiB;
+        }
+        std::vector<uint8_t> out(params.length);
+
+        // At least one hash, then as many as fit the budget
+        size_t count = 0;
+        auto start = clock::now();
+        auto elapsed = clock::duration::zero();
+        do
+        {
+            kdf::derive(params,
+                        {reinterpret_cast<const uint8_t*>(password.data()),
+                         password.size()},
+                        salt, out);
+            count++;
+            elapsed = clock::now() - start;
+        } while (elapsed < budget);
+
+        auto us =
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+                .count();
+        std::cout << name << " iterations " << params.iterations;
+        if (setting.algorithm == kdf::Algorithm::scrypt ||
+            setting.algorithm == kdf::Algorithm::argon2id)
+        {
+            std::cout << " memory " << params.memoryKiB << " KiB";
+        }
+        std::cout << ": " << count * 1000000.0 / us << " hashes/s, "
+                  << us / count << " us per hash\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int ms = argc == 2 ? std::atoi(argv[1]) : 200;
+    if (argc > 2 || ms <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [milliseconds]\n";
+        return 2;
+    }
+
+    try
+    {
+        return benchKdf(std::chrono::milliseconds(ms));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "kdf-bench failed: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
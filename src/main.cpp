@@ -16,6 +16,7 @@
 
 #include "manager.hpp"
 #include "password.hpp"
+#include "rfutility.hpp"
 
 #include <boost/asio.hpp>
 #include <phosphor-logging/elog-errors.hpp>
@@ -30,6 +31,7 @@ int main()
 
     systemBus->request_name(bios_config::service);
     sdbusplus::asio::object_server objectServer(systemBus);
+    bios_config::startRedfishEvents(systemBus);
 
     /**
      * Manager class is responsible for handling methods and signals under
@@ -49,6 +51,23 @@ int main()
      */
     bios_config_pwd::Password password(objectServer, systemBus);
 
+    // Write out changes still held back by the persistence scheduler before
+    // the service is stopped.
+    boost::asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait(
+        [&io, &manager](const boost::system::error_code& ec, int signal) {
+        if (ec)
+        {
+            return;
+        }
+        lg2::info("Received signal {SIGNAL}, flushing BIOS config", "SIGNAL",
+                  signal);
+        manager.flushSerialize();
+        io.stop();
+    });
+
     io.run();
+    manager.flushSerialize();
+    bios_config::stopRedfishEvents();
     return 0;
 }
@@ -25,7 +25,10 @@
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
+#include <systemd/sd-bus.h>
 
+#include <algorithm>
+#include <optional>
 #include <regex>
 
 namespace bios_config
@@ -34,6 +37,30 @@ namespace bios_config
 using namespace sdbusplus::xyz::openbmc_project::Common::Error;
 using namespace sdbusplus::xyz::openbmc_project::BIOSConfig::Common::Error;
 
+/** @brief Properties of extInterfaceName publishing the generation numbers,
+ *         indexed by Generation.
+ */
+static constexpr std::array<const char*, generationCount>
+    generationProperties = {"BaseBIOSTableGeneration",
+                            "PendingAttributesGeneration", "BootGeneration",
+                            "SecureBootGeneration"};
+
+/** @brief Range of a page of a list.
+ *
+ *  @param[in] total - length of the list
+ *  @param[in] offset - index of the first entry of the page
+ *  @param[in] limit - maximum length of the page, 0 for no limit
+ *
+ *  @return The first and the end index of the page.
+ */
+static std::pair<size_t, size_t> page(size_t total, uint32_t offset,
+                                      uint32_t limit)
+{
+    size_t first = std::min<size_t>(offset, total);
+    size_t end = limit == 0 ? total : std::min<size_t>(first + limit, total);
+    return {first, end};
+}
+
 BootOptionDbus::BootOptionDbus(sdbusplus::bus_t& bus, const char* path,
                                Manager& parent, const std::string key) :
     BootOptionDbusBase(bus, path),
@@ -43,42 +70,37 @@ BootOptionDbus::BootOptionDbus(sdbusplus::bus_t& bus, const char* path,
 bool BootOptionDbus::enabled(bool value)
 {
     auto enabled = BootOptionDbusBase::enabled(value, false);
-    parent.bootOptionValues[key]["Enabled"] = enabled;
     auto pendingEnabled = BootOptionDbusBase::pendingEnabled(value, false);
-    parent.bootOptionValues[key]["PendingEnabled"] = pendingEnabled;
-    serialize(parent, parent.biosFile);
+    parent.updateBootOption(
+        key, {{"Enabled", enabled}, {"PendingEnabled", pendingEnabled}});
     return enabled;
 }
 
 bool BootOptionDbus::pendingEnabled(bool value)
 {
     auto v = BootOptionDbusBase::pendingEnabled(value, false);
-    parent.bootOptionValues[key]["PendingEnabled"] = v;
-    serialize(parent, parent.biosFile);
+    parent.updateBootOption(key, {{"PendingEnabled", v}});
     return v;
 }
 
 std::string BootOptionDbus::description(std::string value)
 {
     auto v = BootOptionDbusBase::description(value, false);
-    parent.bootOptionValues[key]["Description"] = v;
-    serialize(parent, parent.biosFile);
+    parent.updateBootOption(key, {{"Description", v}});
     return v;
 }
 
 std::string BootOptionDbus::displayName(std::string value)
 {
     auto v = BootOptionDbusBase::displayName(value, false);
-    parent.bootOptionValues[key]["DisplayName"] = v;
-    serialize(parent, parent.biosFile);
+    parent.updateBootOption(key, {{"DisplayName", v}});
     return v;
 }
 
 std::string BootOptionDbus::uefiDevicePath(std::string value)
 {
     auto v = BootOptionDbusBase::uefiDevicePath(value, false);
-    parent.bootOptionValues[key]["UefiDevicePath"] = v;
-    serialize(parent, parent.biosFile);
+    parent.updateBootOption(key, {{"UefiDevicePath", v}});
     return v;
 }
 
@@ -87,88 +109,375 @@ void BootOptionDbus::delete_()
     parent.deleteBootOption(key);
 }
 
-void Manager::setAttribute(AttributeName attribute, AttributeValue value)
+Manager::PendingAttribute
+    Manager::toPendingAttribute(const AttributeName& attribute,
+                                AttributeValue value) const
 {
-    auto pendingAttrs = Base::pendingAttributes();
-    auto iter = pendingAttrs.find(attribute);
+    Manager::PendingAttribute attributeValue;
 
-    if (iter != pendingAttrs.end())
+    auto id = attributes.find(attribute);
+    const auto* current = id ? pending.find(*id) : nullptr;
+    if (current)
+    {
+        std::get<0>(attributeValue) = std::get<0>(*current);
+    }
+    else if (std::get_if<int64_t>(&value))
     {
-        std::get<1>(iter->second) = value;
+        std::get<0>(attributeValue) = AttributeType::Integer;
     }
     else
     {
-        Manager::PendingAttribute attributeValue;
+        std::get<0>(attributeValue) = AttributeType::String;
+    }
+    std::get<1>(attributeValue) = std::move(value);
+    return attributeValue;
+}
+
+void Manager::setAttribute(AttributeName attribute, AttributeValue value)
+{
+    auto attributeValue = toPendingAttribute(attribute, std::move(value));
+
+    // Only the changed attribute is validated, the others already were
+    updatePendingAttributes(
+        {{std::move(attribute), std::move(attributeValue)}});
+}
+
+Manager::AttributeErrors Manager::setAttributes(AttributeValues values)
+{
+    // A name given more than once takes its last value
+    PendingAttributes changes;
+    for (auto& [attribute, value] : values)
+    {
+        auto attributeValue = toPendingAttribute(attribute, std::move(value));
+        changes.insert_or_assign(std::move(attribute),
+                                 std::move(attributeValue));
+    }
 
-        if (std::get_if<int64_t>(&value))
+    AttributeErrors errors;
+    std::vector<uint32_t> ids;
+    ids.reserve(changes.size());
+    for (const auto& [attribute, attributeValue] : changes)
+    {
+        try
         {
-            std::get<0>(attributeValue) = AttributeType::Integer;
+            ids.push_back(checkPendingAttribute(attribute, attributeValue));
         }
-        else
+        catch (const sdbusplus::exception::exception& e)
         {
-            std::get<0>(attributeValue) = AttributeType::String;
+            errors.emplace_back(attribute, e.name());
         }
-
-        std::get<1>(attributeValue) = value;
-        pendingAttrs.emplace(attribute, attributeValue);
     }
 
-    pendingAttributes(pendingAttrs);
+    // All or nothing, the caller gets every error at once
+    if (errors.empty() && !changes.empty())
+    {
+        applyPendingAttributes(changes, ids);
+    }
+    return errors;
 }
 
 Manager::AttributeDetails Manager::getAttribute(AttributeName attribute)
+{
+    auto id = attributes.find(attribute);
+    if (!id)
+    {
+        throw AttributeNotFound();
+    }
+    return attributeDetails(*id);
+}
+
+Manager::AttributeDetailsMap
+    Manager::getAttributes(const std::vector<AttributeName>& names) const
+{
+    AttributeDetailsMap details;
+    for (const auto& name : names)
+    {
+        if (auto id = attributes.find(name))
+        {
+            details.try_emplace(name, attributeDetails(*id));
+        }
+    }
+    return details;
+}
+
+Manager::AttributeDetailsMap Manager::getAllAttributes() const
+{
+    AttributeDetailsMap details;
+    const auto& image = *attributes.image();
+    for (uint32_t id = 0; id < image.size(); id++)
+    {
+        details.emplace_hint(details.end(), attributes.name(id),
+                             attributeDetails(id));
+    }
+    return details;
+}
+
+std::tuple<std::vector<std::string>, uint32_t>
+    Manager::listMenu(const std::string& path, uint32_t offset,
+                      uint32_t limit) const
+{
+    const auto* node = attributes.menus().find(path);
+    if (node == nullptr)
+    {
+        throw ResourceNotFound();
+    }
+
+    auto [first, end] = page(node->children.size(), offset, limit);
+    std::vector<std::string> children;
+    children.reserve(end - first);
+    auto it = std::next(node->children.begin(), first);
+    for (auto i = first; i < end; i++, it++)
+    {
+        children.emplace_back(it->first);
+    }
+    return {std::move(children), node->children.size()};
+}
+
+std::tuple<Manager::BaseTable, uint32_t>
+    Manager::getMenuAttributes(const std::string& path, uint32_t offset,
+                               uint32_t limit) const
+{
+    const auto* node = attributes.menus().find(path);
+    if (node == nullptr)
+    {
+        throw ResourceNotFound();
+    }
+
+    auto [first, end] = page(node->attributes.size(), offset, limit);
+    BaseTable table;
+    for (auto i = first; i < end; i++)
+    {
+        auto id = node->attributes[i];
+        table.emplace_hint(table.end(), attributes.name(id),
+                           attributes.attribute(id).decode());
+    }
+    return {std::move(table), node->attributes.size()};
+}
+
+std::tuple<uint64_t, Manager::BaseTable>
+    Manager::getBaseBIOSTableIfModified(uint64_t generation) const
+{
+    auto current = generations[static_cast<size_t>(Generation::baseTable)];
+    if (generation == current)
+    {
+        return {current, {}};
+    }
+    return {current, baseBIOSTable()};
+}
+
+std::tuple<uint64_t, Manager::PendingAttributes>
+    Manager::getPendingAttributesIfModified(uint64_t generation) const
+{
+    auto current =
+        generations[static_cast<size_t>(Generation::pendingAttributes)];
+    if (generation == current)
+    {
+        return {current, {}};
+    }
+    return {current, pendingAttributes()};
+}
+
+Manager::AttributeDetails Manager::attributeDetails(uint32_t id) const
 {
     Manager::AttributeDetails value;
 
-    auto table = Base::baseBIOSTable();
-    auto iter = table.find(attribute);
+    auto attr = attributes.attribute(id);
+    std::get<0>(value) = attr.type();
+    std::get<1>(value) = TableImage::toValue(attr.currentValue());
 
-    if (iter != table.end())
+    if (const auto* pendingValue = pending.find(id))
+    {
+        std::get<2>(value) = std::get<1>(*pendingValue);
+    }
+    else if (std::get_if<std::string>(&std::get<1>(value)))
     {
-        std::get<0>(value) =
-            std::get<static_cast<uint8_t>(Index::attributeType)>(iter->second);
-        std::get<1>(value) =
-            std::get<static_cast<uint8_t>(Index::currentValue)>(iter->second);
+        std::get<2>(value) = std::string();
+    }
 
-        auto pending = Base::pendingAttributes();
-        auto pendingIter = pending.find(attribute);
-        if (pendingIter != pending.end())
+    return value;
+}
+
+Manager::BaseTable Manager::baseBIOSTable(BaseTable value)
+{
+    // The image is the only copy of the table that is kept, the property
+    // storage of the base class stays empty and reads go through the
+    // baseBIOSTable() getter.
+    auto image = TableImage::build(value);
+    const auto& current = *attributes.image();
+    // A patched image holds the same table in other bytes than a built one
+    if (image->data() == current.data() ||
+        (image->size() == current.size() && current.table() == value))
+    {
+        // Hosts send the same table on every boot. The write is elided only
+        // when there are no pending values to clear either.
+        if (pending.empty())
         {
-            std::get<2>(value) = std::get<1>(pendingIter->second);
+            elidedWrites++;
         }
-        else if (std::get_if<std::string>(&std::get<1>(value)))
+        else
         {
-            std::get<2>(value) = std::string();
+            updatePendingAttributes({});
         }
     }
     else
     {
-        throw AttributeNotFound();
-    }
+        std::optional<AttributeTable> compiled;
+        try
+        {
+            compiled.emplace(std::move(image), true);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            lg2::error("Rejecting BaseBIOSTable: {ERROR}", "ERROR", e);
+            throw InvalidArgument();
+        }
+
+        // The pending IDs refer to the old table
+        if (!pending.empty())
+        {
+            updatePendingAttributes({});
+        }
+
+        // Attributes whose current value the new table changes
+        std::vector<std::pair<AttributeDetails, uint32_t>> updated;
+        for (uint32_t id = 0; id < compiled->image()->size(); id++)
+        {
+            auto previous = attributes.find(compiled->name(id));
+            if (previous &&
+                attributes.attribute(*previous).currentValue() !=
+                    compiled->attribute(id).currentValue())
+            {
+                updated.emplace_back(attributeDetails(*previous), id);
+            }
+        }
 
+        attributes = std::move(*compiled);
+        bumpGeneration(Generation::baseTable);
+        emitMapChanged("BaseBIOSTable", attributes.image()->size());
+        std::vector<AttributeChange> changes;
+        changes.reserve(updated.size());
+        for (const auto& [before, id] : updated)
+        {
+            changes.emplace_back(attributeChange(attributes.name(id), before,
+                                                 attributeDetails(id)));
+        }
+        emitAttributeChanged(changes);
+        scheduleSerialize(Section::baseTable);
+    }
+    Base::resetBIOSSettings(Base::ResetFlag::NoAction);
     return value;
 }
 
-Manager::BaseTable Manager::baseBIOSTable(BaseTable value)
+Manager::BaseTable Manager::baseBIOSTable() const
 {
-    pendingAttributes({});
-    auto baseTable = Base::baseBIOSTable(value, false);
-    serialize(*this, biosFile);
-    Base::resetBIOSSettings(Base::ResetFlag::NoAction);
-    return baseTable;
+    return attributes.image()->table();
+}
+
+void Manager::updateBaseBIOSTable(BaseTable upserts,
+                                  std::vector<std::string> removals)
+{
+    for (const auto& name : removals)
+    {
+        if (upserts.contains(name))
+        {
+            lg2::error("Attribute {NAME} is both updated and removed",
+                       "NAME", name);
+            throw InvalidArgument();
+        }
+    }
+
+    // Only what actually differs from the current table is applied, hosts
+    // tend to report every attribute they touched
+    std::erase_if(upserts, [this](const auto& upsert) {
+        auto id = attributes.find(upsert.first);
+        return id && attributes.attribute(*id).decode() == upsert.second;
+    });
+    std::erase_if(removals, [this](const std::string& name) {
+        return !attributes.find(name);
+    });
+    if (upserts.empty() && removals.empty())
+    {
+        elidedWrites++;
+        return;
+    }
+
+    std::vector<std::pair<std::string, AttributeDetails>> updated;
+    for (const auto& [name, attr] : upserts)
+    {
+        if (auto id = attributes.find(name))
+        {
+            updated.emplace_back(name, attributeDetails(*id));
+        }
+    }
+
+    // The pending IDs refer to the old table, the values of the attributes
+    // that did not change are carried over by name
+    auto values = pending.attributes(attributes);
+    std::vector<std::string> dropped;
+    for (const auto& [name, attr] : upserts)
+    {
+        if (values.erase(name) != 0)
+        {
+            dropped.push_back(name);
+        }
+    }
+    for (const auto& name : removals)
+    {
+        if (values.erase(name) != 0)
+        {
+            dropped.push_back(name);
+        }
+    }
+
+    try
+    {
+        attributes.update(upserts, removals, true);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        lg2::error("Rejecting BaseBIOSTable update: {ERROR}", "ERROR", e);
+        throw InvalidArgument();
+    }
+    pending.assign(attributes, values);
+
+    bumpGeneration(Generation::baseTable);
+    auto signal = extInterface->new_signal("BaseBIOSTableUpdated");
+    signal.append(upserts, removals);
+    signal.signal_send();
+
+    std::vector<AttributeChange> changes;
+    for (const auto& [name, before] : updated)
+    {
+        auto after = attributeDetails(*attributes.find(name));
+        if (after != before)
+        {
+            changes.emplace_back(attributeChange(name, before, after));
+        }
+    }
+    emitAttributeChanged(changes);
+
+    scheduleSerialize(
+        journal::BaseTableDelta{std::move(upserts), std::move(removals)});
+
+    if (!dropped.empty())
+    {
+        bumpGeneration(Generation::pendingAttributes);
+        emitMapChanged("PendingAttributes", pending.size());
+        scheduleSerialize(journal::DropPendingAttributes{std::move(dropped)});
+    }
 }
 
 bool Manager::enableAfterReset(bool value)
 {
     auto enableAfterResetFlag = Base::enableAfterReset(value, false);
-    serialize(*this, biosFile);
+    scheduleSerialize(journal::EnableAfterReset{enableAfterResetFlag});
     return enableAfterResetFlag;
 }
 
 bool Manager::credentialBootstrap(bool value)
 {
     auto credentialBootstrapFlag = Base::credentialBootstrap(value, false);
-    serialize(*this, biosFile);
+    scheduleSerialize(journal::CredentialBootstrap{credentialBootstrapFlag});
     return credentialBootstrapFlag;
 }
 
@@ -178,7 +487,6 @@ sdbusplus::common::xyz::openbmc_project::bios_config::Manager::ResetFlag
             value)
 {
     auto resetFlag = Base::resetBIOSSettings(value, false);
-    serialize(*this, biosFile);
 
     // Below block of code is to send event when ResetBIOSSettings property is
     // modified.
@@ -189,212 +497,109 @@ sdbusplus::common::xyz::openbmc_project::bios_config::Manager::ResetFlag
     return resetFlag;
 }
 
-bool Manager::validateEnumOption(
-    const std::string& attrValue,
-    const std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>,
-                                 std::string>>& options)
+Manager::PendingAttributes Manager::pendingAttributes(PendingAttributes value)
 {
-    for (const auto& enumOptions : options)
-    {
-        if ((BoundType::OneOf == std::get<0>(enumOptions)) &&
-            (attrValue == std::get<std::string>(std::get<1>(enumOptions))))
-        {
-            return true;
-        }
-    }
-
-    lg2::error("No valid attribute");
-    return false;
+    updatePendingAttributes(value);
+    return pendingAttributes();
 }
 
-bool Manager::validateStringOption(
-    const std::string& attrValue,
-    const std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>,
-                                 std::string>>& options)
+void Manager::updatePendingAttributes(const PendingAttributes& value)
 {
-    size_t minStringLength = 0;
-    size_t maxStringLength = 0;
-    for (const auto& stringOptions : options)
+    // Clear the pending attributes
+    if (value.empty())
     {
-        if (BoundType::MinStringLength == std::get<0>(stringOptions))
+        if (pending.empty())
         {
-            minStringLength = std::get<int64_t>(std::get<1>(stringOptions));
+            elidedWrites++;
+            return;
         }
-        else if (BoundType::MaxStringLength == std::get<0>(stringOptions))
+        std::vector<std::pair<uint32_t, AttributeDetails>> cleared;
+        for (auto id : pending.ids())
         {
-            maxStringLength = std::get<int64_t>(std::get<1>(stringOptions));
+            cleared.emplace_back(id, attributeDetails(id));
         }
-        else
+        pending.clear();
+
+        std::vector<AttributeChange> changes;
+        changes.reserve(cleared.size());
+        for (const auto& [id, before] : cleared)
         {
-            continue;
+            changes.emplace_back(attributeChange(attributes.name(id), before,
+                                                 attributeDetails(id)));
         }
+        bumpGeneration(Generation::pendingAttributes);
+        emitMapChanged("PendingAttributes", 0);
+        emitAttributeChanged(changes);
+        scheduleSerialize(journal::ClearPendingAttributes{});
+        return;
     }
 
-    if (attrValue.length() < minStringLength ||
-        attrValue.length() > maxStringLength)
+    // Validate all the BIOS attributes before setting PendingAttributes
+    std::vector<uint32_t> ids;
+    ids.reserve(value.size());
+    for (const auto& pair : value)
     {
-        lg2::error(
-            "{ATTRVALUE} Length is out of range, bound is invalid, maxStringLength = {MAXLEN}, minStringLength = {MINLEN}",
-            "ATTRVALUE", attrValue, "MAXLEN", maxStringLength, "MINLEN",
-            minStringLength);
-        return false;
+        ids.push_back(checkPendingAttribute(pair.first, pair.second));
     }
-
-    return true;
+    applyPendingAttributes(value, ids);
 }
 
-bool Manager::validateIntegerOption(
-    const int64_t& attrValue,
-    const std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>,
-                                 std::string>>& options)
+uint32_t Manager::checkPendingAttribute(const std::string& name,
+                                        const PendingAttribute& value) const
 {
-    int64_t lowerBound = 0;
-    int64_t upperBound = 0;
-    int64_t scalarIncrement = 0;
-
-    for (const auto& integerOptions : options)
+    auto id = attributes.find(name);
+    // BIOS attribute not found in the BaseBIOSTable
+    if (!id)
     {
-        if (BoundType::LowerBound == std::get<0>(integerOptions))
-        {
-            lowerBound = std::get<int64_t>(std::get<1>(integerOptions));
-        }
-        else if (BoundType::UpperBound == std::get<0>(integerOptions))
-        {
-            upperBound = std::get<int64_t>(std::get<1>(integerOptions));
-        }
-        else if (BoundType::ScalarIncrement == std::get<0>(integerOptions))
-        {
-            scalarIncrement = std::get<int64_t>(std::get<1>(integerOptions));
-        }
+        lg2::error("BIOS attribute not found in the BaseBIOSTable");
+        throw AttributeNotFound();
     }
 
-    if ((attrValue < lowerBound) || (attrValue > upperBound))
+    const auto& validator = attributes.validator(*id);
+    if (validator.type() != std::get<0>(value))
     {
-        lg2::error("Integer, bound is invalid");
-        return false;
+        lg2::error("attributeType is not same with bios base table");
+        throw InvalidArgument();
     }
 
-    if (scalarIncrement == 0 ||
-        ((std::abs(attrValue - lowerBound)) % scalarIncrement) != 0)
+    if (!validator.validate(std::get<1>(value)))
     {
-        lg2::error(
-            "((std::abs({ATTR_VALUE} - {LOWER_BOUND})) % {SCALAR_INCREMENT}) != 0",
-            "ATTR_VALUE", attrValue, "LOWER_BOUND", lowerBound,
-            "SCALAR_INCREMENT", scalarIncrement);
-        return false;
+        throw InvalidArgument();
     }
-
-    return true;
+    return *id;
 }
 
-Manager::PendingAttributes Manager::pendingAttributes(PendingAttributes value)
+void Manager::applyPendingAttributes(const PendingAttributes& value,
+                                     const std::vector<uint32_t>& ids)
 {
-    // Clear the pending attributes
-    if (value.empty())
-    {
-        auto pendingAttrs = Base::pendingAttributes({}, false);
-        serialize(*this, biosFile);
-        return pendingAttrs;
-    }
-
-    // Validate all the BIOS attributes before setting PendingAttributes
-    BaseTable biosTable = Base::baseBIOSTable();
+    std::vector<AttributeChange> changes;
+    auto id = ids.begin();
     for (const auto& pair : value)
     {
-        auto iter = biosTable.find(pair.first);
-        // BIOS attribute not found in the BaseBIOSTable
-        if (iter == biosTable.end())
-        {
-            lg2::error("BIOS attribute not found in the BaseBIOSTable");
-            throw AttributeNotFound();
-        }
-
-        auto attributeType =
-            std::get<static_cast<uint8_t>(Index::attributeType)>(iter->second);
-        if (attributeType != std::get<0>(pair.second))
-        {
-            lg2::error("attributeType is not same with bios base table");
-            throw InvalidArgument();
-        }
-
-        // Validate enumeration BIOS attributes
-        if (attributeType == AttributeType::Enumeration)
-        {
-            // For enumeration the expected variant types is Enumeration
-            if (std::get<1>(pair.second).index() == 0)
-            {
-                lg2::error("Enumeration property value is not enum");
-                throw InvalidArgument();
-            }
-
-            const auto& attrValue =
-                std::get<std::string>(std::get<1>(pair.second));
-            const auto& options =
-                std::get<static_cast<uint8_t>(Index::options)>(iter->second);
-
-            if (!validateEnumOption(attrValue, options))
-            {
-                throw InvalidArgument();
-            }
-        }
-
-        if (attributeType == AttributeType::String)
-        {
-            // For enumeration the expected variant types is std::string
-            if (std::get<1>(pair.second).index() == 0)
-            {
-                lg2::error("String property value is not string");
-                throw InvalidArgument();
-            }
-
-            const auto& attrValue =
-                std::get<std::string>(std::get<1>(pair.second));
-            const auto& options =
-                std::get<static_cast<uint8_t>(Index::options)>(iter->second);
-
-            if (!validateStringOption(attrValue, options))
-            {
-                throw InvalidArgument();
-            }
-        }
-
-        if (attributeType == AttributeType::Integer)
+        auto before = attributeDetails(*id);
+        if (!pending.set(*id, pair.second))
         {
-            // For enumeration the expected variant types is Integer
-            if (std::get<1>(pair.second).index() == 1)
-            {
-                lg2::error("Enumeration property value is not int");
-                throw InvalidArgument();
-            }
-
-            const auto& attrValue = std::get<int64_t>(std::get<1>(pair.second));
-            const auto& options =
-                std::get<static_cast<uint8_t>(Index::options)>(iter->second);
-
-            if (!validateIntegerOption(attrValue, options))
-            {
-                throw InvalidArgument();
-            }
+            // Re-sent with the same value, nothing to persist
+            elidedWrites++;
+            id++;
+            continue;
         }
+        changes.emplace_back(
+            attributeChange(pair.first, before, attributeDetails(*id++)));
+        scheduleSerialize(journal::PendingAttribute{pair.first, pair.second});
     }
 
-    PendingAttributes pendingAttribute = Base::pendingAttributes();
-
-    for (const auto& pair : value)
+    if (!changes.empty())
     {
-        auto iter = pendingAttribute.find(pair.first);
-        if (iter != pendingAttribute.end())
-        {
-            iter = pendingAttribute.erase(iter);
-        }
-
-        pendingAttribute.emplace(std::make_pair(pair.first, pair.second));
+        bumpGeneration(Generation::pendingAttributes);
+        emitMapChanged("PendingAttributes", pending.size());
+        emitAttributeChanged(changes);
     }
+}
 
-    auto pendingAttrs = Base::pendingAttributes(pendingAttribute, false);
-    serialize(*this, biosFile);
-
-    return pendingAttrs;
+Manager::PendingAttributes Manager::pendingAttributes() const
+{
+    return pending.attributes(attributes);
 }
 
 void Manager::createBootOption(std::string id)
@@ -419,7 +624,8 @@ void Manager::createBootOption(std::string id)
                                                                     v.second);
     }
 
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::boot);
+    scheduleSerialize(journal::BootOption{key, bootOptionValues[key]});
 }
 
 void Manager::deleteBootOption(const std::string& key)
@@ -427,7 +633,34 @@ void Manager::deleteBootOption(const std::string& key)
     bootOptionValues.erase(key);
     dbusBootOptions.erase(key);
 
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::boot);
+    scheduleSerialize(journal::DeleteBootOption{key});
+}
+
+void Manager::updateBootOption(const std::string& key,
+                               const BootOptionDataType& changes)
+{
+    auto& values = bootOptionValues[key];
+    bool changed = false;
+    for (const auto& [name, value] : changes)
+    {
+        auto iter = values.find(name);
+        if (iter == values.end() || iter->second != value)
+        {
+            values.insert_or_assign(name, value);
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        bumpGeneration(Generation::boot);
+        scheduleSerialize(journal::BootOption{key, values});
+    }
+    else
+    {
+        elidedWrites++;
+    }
 }
 
 Manager::BootOptionsType Manager::getBootOptionValues() const
@@ -439,7 +672,7 @@ void Manager::setBootOptionValues(const BootOptionsType& loaded)
 {
     bootOptionValues = loaded;
     dbusBootOptions.clear();
-    for (const auto& [key, values] : bootOptionValues)
+    for (const auto& [key, values] : loaded)
     {
         std::string path = std::string(bootOptionsPath) + "/" + key;
         dbusBootOptions[key] = std::make_unique<BootOptionDbus>(
@@ -451,13 +684,18 @@ void Manager::setBootOptionValues(const BootOptionsType& loaded)
         }
         // In case of loading from a file with old version that doesn't
         // include the PendingEnabled property, set it to the same value as
-        // Enabled
+        // Enabled. This runs while the state is restored, so the section is
+        // only queued for a rewrite, the constructor starts the first write
+        // once everything is restored.
         auto enabledIt = values.find("Enabled");
         auto pendingEnabledIt = values.find("PendingEnabled");
         if (enabledIt != values.end() && pendingEnabledIt == values.end())
         {
-            dbusBootOptions[key]->pendingEnabled(
-                std::get<bool>(enabledIt->second));
+            bool enabled = std::get<bool>(enabledIt->second);
+            dbusBootOptions[key]->BootOptionDbusBase::pendingEnabled(enabled,
+                                                                     true);
+            bootOptionValues[key]["PendingEnabled"] = enabled;
+            persistence.markDirty(Section::bootOptions);
         }
     }
 }
@@ -466,24 +704,29 @@ Manager::BootOrderType Manager::bootOrder(Manager::BootOrderType value)
 {
     auto newValue = Base::bootOrder(value, false);
 #ifdef CLEAR_PENDING_BOOTORDER_ON_UPDATE
-    Manager::pendingBootOrder(std::vector<std::string>());
+    auto pending = Base::pendingBootOrder(std::vector<std::string>(), false);
 #else
-    Manager::pendingBootOrder(value);
+    auto pending = Base::pendingBootOrder(value, false);
 #endif
+    // One change of the boot part, both values in one record
+    bumpGeneration(Generation::boot);
+    scheduleSerialize(journal::BootOrderChange{newValue, pending});
     return newValue;
 }
 
 Manager::BootOrderType Manager::pendingBootOrder(Manager::BootOrderType value)
 {
     auto newValue = Base::pendingBootOrder(value, false);
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::boot);
+    scheduleSerialize(journal::PendingBootOrder{newValue});
     return newValue;
 }
 
 Manager::CurrentBootType Manager::currentBoot(Manager::CurrentBootType value)
 {
     auto newValue = Base::currentBoot(value, false);
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::secureBoot);
+    scheduleSerialize(journal::CurrentBoot{newValue});
     using namespace phosphor::logging;
     // Below block of code is to send event when CurrentBoot property is
     // modified.
@@ -496,7 +739,8 @@ Manager::CurrentBootType Manager::currentBoot(Manager::CurrentBootType value)
 bool Manager::enable(bool value)
 {
     auto newValue = Base::enable(value, false);
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::secureBoot);
+    scheduleSerialize(journal::SecureBootEnable{newValue});
     sendRedfishEvent("SecureBootEnable", std::to_string(value), objectPath);
     return newValue;
 }
@@ -504,7 +748,8 @@ bool Manager::enable(bool value)
 Manager::ModeType Manager::mode(Manager::ModeType value)
 {
     auto newValue = Base::mode(value, false);
-    serialize(*this, biosFile);
+    bumpGeneration(Generation::secureBoot);
+    scheduleSerialize(journal::SecureBootMode{newValue});
     using namespace phosphor::logging;
     // Below block of code is to send event when SecureBootMode property is
     // modified.
@@ -513,75 +758,317 @@ Manager::ModeType Manager::mode(Manager::ModeType value)
     return newValue;
 }
 
+void Manager::emitChanged(const char* property)
+{
+    sd_bus_emit_properties_changed(
+        systemBus->get(), objectPath,
+        sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
+            interface,
+        property, nullptr);
+}
+
+void Manager::emitMapChanged(const char* property, size_t entries)
+{
+    // Subscribers of a large map follow the AttributeChanged deltas instead
+    if (FULL_MAP_SIGNAL_LIMIT != 0 && entries > FULL_MAP_SIGNAL_LIMIT)
+    {
+        return;
+    }
+    emitChanged(property);
+}
+
+Manager::AttributeChange
+    Manager::attributeChange(std::string_view name,
+                             const AttributeDetails& before,
+                             const AttributeDetails& after)
+{
+    return {std::string(name), std::get<1>(before), std::get<1>(after),
+            std::get<2>(before), std::get<2>(after)};
+}
+
+void Manager::emitAttributeChanged(const std::vector<AttributeChange>& changes)
+{
+    if (changes.empty())
+    {
+        return;
+    }
+    auto signal = extInterface->new_signal("AttributeChanged");
+    signal.append(changes);
+    signal.signal_send();
+}
+
+void Manager::bumpGeneration(Generation generation)
+{
+    auto index = static_cast<size_t>(generation);
+    generations[index]++;
+    generationsChanged.set(index);
+    // Boot options restored while constructing change before the interface
+    // exists
+    if (extInterface)
+    {
+        extInterface->signal_property(generationProperties[index]);
+    }
+}
+
+void Manager::scheduleSerialize(Section section)
+{
+    persistence.markDirty(section);
+    persistScheduler.markDirty();
+}
+
+void Manager::scheduleSerialize(journal::Record record)
+{
+    persistence.record(std::move(record));
+    persistScheduler.markDirty();
+}
+
+void Manager::snapshot(Section section, Snapshot& state) const
+{
+    switch (section)
+    {
+        case Section::baseTable:
+            state.baseTable = attributes.image();
+            break;
+        case Section::pendingAttributes:
+            state.pendingAttributes = pending.attributes(attributes);
+            break;
+        case Section::settings:
+            state.enableAfterReset = Base::enableAfterReset();
+            state.credentialBootstrap = Base::credentialBootstrap();
+            break;
+        case Section::bootOrder:
+            state.bootOrder = Base::bootOrder();
+            state.pendingBootOrder = Base::pendingBootOrder();
+            break;
+        case Section::bootOptions:
+            state.bootOptions = bootOptionValues;
+            break;
+        case Section::secureBoot:
+            state.currentBoot = Base::currentBoot();
+            state.enable = Base::enable();
+            state.mode = Base::mode();
+            break;
+        case Section::generations:
+            state.generations = generations;
+            break;
+    }
+}
+
+void Manager::restore(const Snapshot& state)
+{
+    attributes = AttributeTable(state.baseTable, false);
+    pending.assign(attributes, state.pendingAttributes);
+    Base::enableAfterReset(state.enableAfterReset, true);
+    Base::credentialBootstrap(state.credentialBootstrap, true);
+    Base::bootOrder(state.bootOrder, true);
+    Base::pendingBootOrder(state.pendingBootOrder, true);
+    setBootOptionValues(state.bootOptions);
+    Base::currentBoot(state.currentBoot, true);
+    Base::enable(state.enable, true);
+    Base::mode(state.mode, true);
+    generations = state.generations;
+}
+
+void Manager::persist()
+{
+    if (persistInFlight)
+    {
+        // One batch at a time, the changes are picked up once it completes
+        persistAgain = true;
+        return;
+    }
+
+    for (size_t i = 0; i < generationCount; i++)
+    {
+        if (generationsChanged.test(i))
+        {
+            persistence.record(journal::GenerationNumber{
+                static_cast<Generation>(i), generations[i]});
+        }
+    }
+    generationsChanged.reset();
+
+    auto batch = persistence.prepare();
+    if (!batch)
+    {
+        return;
+    }
+    for (size_t i = 0; i < sectionCount; i++)
+    {
+        if (batch->sections.test(i))
+        {
+            snapshot(static_cast<Section>(i), batch->state);
+        }
+    }
+
+    persistInFlight = true;
+    worker.post([this, batch]() { persistence.write(*batch); },
+                [this, batch](std::exception_ptr) { persistDone(*batch); });
+}
+
+void Manager::persistDone(const Persistence::Batch& batch)
+{
+    persistInFlight = false;
+    bool compact = persistence.complete(batch);
+
+    if (batch.error)
+    {
+        try
+        {
+            std::rethrow_exception(batch.error);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to persist BIOS config: {ERROR}", "ERROR", e);
+        }
+        persistAgain = false;
+        persistScheduler.retry();
+        return;
+    }
+
+    if (compact)
+    {
+        // Fold the journal into the sections once the io loop is idle, the
+        // flush that crossed the threshold stays an append.
+        boost::asio::post(systemBus->get_io_context(), [this]() {
+            persistence.compact();
+            persistScheduler.markDirty();
+            persistScheduler.flush();
+        });
+    }
+
+    if (persistAgain || persistence.pending())
+    {
+        persistAgain = false;
+        persistScheduler.markDirty();
+    }
+}
+
+void Manager::flushSerialize()
+{
+    // Runs on shutdown, wait for the writer instead of returning to the io
+    // loop. A batch may still be in flight and a failed append is retried
+    // by one more batch, more rounds are not waited for.
+    for (int round = 0;
+         round < 3 && (persistInFlight || persistScheduler.dirty()); round++)
+    {
+        persistScheduler.flush();
+        worker.drain();
+    }
+
+    // Tells the next start that no change of this run is lost
+    try
+    {
+        if (persistInFlight || persistScheduler.dirty() ||
+            !persistence.markClean())
+        {
+            lg2::error("BIOS config changes were not flushed before shutdown");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to mark the BIOS config clean: {ERROR}", "ERROR",
+                   e);
+    }
+}
+
 Manager::Manager(sdbusplus::asio::object_server& objectServer,
                  std::shared_ptr<sdbusplus::asio::connection>& systemBus) :
     bios_config::Base(*systemBus, objectPath),
-    objServer(objectServer), systemBus(systemBus)
-{
-    fs::path biosDir(BIOS_PERSIST_PATH);
-    fs::create_directories(biosDir);
-    biosFile = biosDir / biosPersistFile;
-    deserialize(biosFile, *this);
-}
-
-// Utility function to convert BaseTableV1 to BaseTable
-Manager::BaseTable
-    Manager::convertBaseTableV1ToBaseTable(const Manager::BaseTableV1& tableV1)
-{
-    Manager::BaseTable table;
-
-    for (const auto& [key, tupleV1] : tableV1)
-    {
-        // Extract fields from tupleV1
-        AttributeType attrType = std::get<0>(tupleV1);
-        bool boolValue = std::get<1>(tupleV1);
-        std::string str1 = std::get<2>(tupleV1);
-        std::string str2 = std::get<3>(tupleV1);
-        std::string str3 = std::get<4>(tupleV1);
-        std::variant<int64_t, std::string> var1 = std::get<5>(tupleV1);
-        std::variant<int64_t, std::string> var2 = std::get<6>(tupleV1);
-        std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>>>
-            vecV1 = std::get<7>(tupleV1);
-
-        // Create the corresponding tuple for BaseTable with additional fields
-        // set to default values
-        std::tuple<
-            AttributeType, bool, std::string, std::string, std::string,
-            std::variant<int64_t, std::string>,
-            std::variant<int64_t, std::string>,
-            std::vector<std::tuple<
-                BoundType, std::variant<int64_t, std::string>, std::string>>>
-            tuple;
-
-        // Copy existing fields
-        std::get<0>(tuple) = attrType;
-        std::get<1>(tuple) = boolValue;
-        std::get<2>(tuple) = str1;
-        std::get<3>(tuple) = str2;
-        std::get<4>(tuple) = str3;
-        std::get<5>(tuple) = var1;
-        std::get<6>(tuple) = var2;
-
-        // Copy vector with additional fields set to default values
-        std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>,
-                               std::string>>
-            vec;
-
-        for (const auto& entry : vecV1)
+    objServer(objectServer), systemBus(systemBus),
+    biosFile(fs::path(BIOS_PERSIST_PATH) / biosPersistFile),
+    attributes(TableImage::build({}), false),
+    persistence(biosFile),
+    persistScheduler(
+        systemBus->get_io_context(), [this]() { persist(); },
+        std::chrono::milliseconds(PERSIST_QUIET_PERIOD_MS),
+        std::chrono::milliseconds(PERSIST_MAX_DELAY_MS)),
+    worker(systemBus->get_io_context())
+{
+    fs::create_directories(biosFile.parent_path());
+    // Sections that are not persisted keep the defaults of the object
+    Snapshot state;
+    for (size_t i = 0; i < sectionCount; i++)
+    {
+        snapshot(static_cast<Section>(i), state);
+    }
+    if (persistence.load(state))
+    {
+        restore(state);
+    }
+    if (!persistence.cleanShutdown())
+    {
+        // Changes of the previous run that were not flushed are lost, move
+        // every generation past the numbers clients may have seen for them
+        for (size_t i = 0; i < generationCount; i++)
         {
-            BoundType boundType = std::get<0>(entry);
-            std::variant<int64_t, std::string> var = std::get<1>(entry);
-            vec.emplace_back(boundType, var, "");
+            bumpGeneration(static_cast<Generation>(i));
         }
-
-        tuple = std::make_tuple(attrType, boolValue, str1, str2, str3, var1,
-                                var2, vec);
-
-        // Insert into the new BaseTable
-        table[key] = tuple;
+    }
+    // Persists the bumped generations, and finishes a migration or a journal
+    // reset left over from loading
+    if (generationsChanged.any() || persistence.pending())
+    {
+        persistScheduler.markDirty();
     }
 
-    return table;
+    extInterface = objServer.add_interface(objectPath, extInterfaceName);
+    extInterface->register_property_r<uint64_t>(
+        "ElidedWrites", 0, sdbusplus::vtable::property_::none,
+        [this](const uint64_t&) {
+        return elidedWrites + persistence.elidedWrites();
+    });
+    extInterface->register_property_r<uint64_t>(
+        "SuppressedRedfishEvents", 0, sdbusplus::vtable::property_::none,
+        [](const uint64_t&) {
+        const auto& stats = redfishEventStats();
+        return stats.duplicates + stats.rateLimited + stats.dropped;
+    });
+    for (size_t i = 0; i < generationCount; i++)
+    {
+        extInterface->register_property_r<uint64_t>(
+            generationProperties[i], 0,
+            sdbusplus::vtable::property_::emits_change,
+            [this, i](const uint64_t&) { return generations[i]; });
+    }
+    extInterface->register_method(
+        "GetBaseBIOSTableIfModified", [this](uint64_t generation) {
+        return getBaseBIOSTableIfModified(generation);
+    });
+    extInterface->register_method(
+        "GetPendingAttributesIfModified", [this](uint64_t generation) {
+        return getPendingAttributesIfModified(generation);
+    });
+    extInterface->register_method(
+        "UpdateBaseBIOSTable",
+        [this](BaseTable upserts, std::vector<std::string> removals) {
+        updateBaseBIOSTable(std::move(upserts), std::move(removals));
+    });
+    extInterface->register_method("SetAttributes",
+                                  [this](AttributeValues values) {
+        return setAttributes(std::move(values));
+    });
+    extInterface->register_method(
+        "GetAttributes", [this](const std::vector<AttributeName>& names) {
+        return getAttributes(names);
+    });
+    extInterface->register_method("GetAllAttributes",
+                                  [this]() { return getAllAttributes(); });
+    extInterface->register_method(
+        "ListMenu",
+        [this](const std::string& path, uint32_t offset, uint32_t limit) {
+        return listMenu(path, offset, limit);
+    });
+    extInterface->register_method(
+        "GetMenuAttributes",
+        [this](const std::string& path, uint32_t offset, uint32_t limit) {
+        return getMenuAttributes(path, offset, limit);
+    });
+    extInterface->register_signal<BaseTable, std::vector<std::string>>(
+        "BaseBIOSTableUpdated");
+    extInterface->register_signal<std::vector<AttributeChange>>(
+        "AttributeChanged");
+    extInterface->initialize();
 }
 
 } // namespace bios_config
@@ -1,7 +1,13 @@
 #include "manager_serialize.hpp"
 
+#include "crc32c.hpp"
+#include "journal.hpp"
+#include "persist_file.hpp"
+#include "table_image.hpp"
+
 #include <cereal/archives/binary.hpp>
 #include <cereal/cereal.hpp>
+#include <cereal/types/array.hpp>
 #include <cereal/types/map.hpp>
 #include <cereal/types/string.hpp>
 #include <cereal/types/tuple.hpp>
@@ -9,191 +15,1406 @@
 #include <cereal/types/vector.hpp>
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
 
 namespace bios_config
 {
 
-// BIOS_CONFIG_VERSION is introduced to manage backward compatibility with
-// old BaseTableV1 where had not added the support version flag in the archived
-// data itself. To manage this the deserialize will try to decode with
-// BaseTableV1 when there is exception to read the version itself. If the
-// version in the archive is been read correctly then next version checks will
-// be handled.
-//  BaseTable - Maps to Version 2
-//  BaseTableV1 - Maps to version 1
+// Releases before the split into sections archived the whole state into a
+// single file. The version was only added to the archive with version 2, so
+// an archive that fails to decode as version 3 or 2 is decoded as version 1.
+//  Version 1: Bios table type 1
+//  Version 2: Bios table type 2 + version + pendingBootEnable - The type
+//             remain map of variant (bool and string), but additional bool
+//             was added.
+//  Version 3: Bios table type 2 + version + credentialBootstrapFlag
+constexpr std::uint32_t legacyVersion1 = 1;
+constexpr std::uint32_t legacyVersion2 = 2;
+constexpr std::uint32_t legacyVersion3 = 3;
+
+using BoundType =
+    sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::BoundType;
+
+using BaseTableV1 = std::map<
+    std::string,
+    std::tuple<journal::AttributeType, bool, std::string, std::string,
+               std::string, std::variant<int64_t, std::string>,
+               std::variant<int64_t, std::string>,
+               std::vector<std::tuple<BoundType,
+                                      std::variant<int64_t, std::string>>>>>;
+
+// Utility function to convert BaseTableV1 to BaseTable. The fields are moved
+// out of the old table, it is only decoded to be converted.
+static TableImage::BaseTable convertBaseTableV1ToBaseTable(BaseTableV1 tableV1)
+{
+    TableImage::BaseTable table;
+
+    for (auto& [key, tupleV1] : tableV1)
+    {
+        auto& [attrType, readOnly, displayName, description, menuPath,
+               currentValue, defaultValue, optionsV1] = tupleV1;
+
+        // Copy vector with the value description set to its default value
+        std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>,
+                               std::string>>
+            options;
+        options.reserve(optionsV1.size());
+        for (auto& [boundType, value] : optionsV1)
+        {
+            options.emplace_back(boundType, std::move(value), "");
+        }
+
+        // Insert into the new BaseTable, both tables are sorted by key
+        table.emplace_hint(
+            table.end(), key,
+            std::make_tuple(attrType, readOnly, std::move(displayName),
+                            std::move(description), std::move(menuPath),
+                            std::move(currentValue), std::move(defaultValue),
+                            std::move(options)));
+    }
+
+    return table;
+}
+
+// Utility function to convert BaseTable to BaseTableV1, the value
+// descriptions of the options are dropped.
+static BaseTableV1
+    convertBaseTableToBaseTableV1(const TableImage::BaseTable& table)
+{
+    BaseTableV1 tableV1;
+
+    for (const auto& [key, tuple] : table)
+    {
+        const auto& [attrType, readOnly, displayName, description, menuPath,
+                     currentValue, defaultValue, options] = tuple;
+
+        std::vector<std::tuple<BoundType, std::variant<int64_t, std::string>>>
+            optionsV1;
+        optionsV1.reserve(options.size());
+        for (const auto& [boundType, value, valueDescription] : options)
+        {
+            optionsV1.emplace_back(boundType, value);
+        }
+
+        tableV1.emplace_hint(
+            tableV1.end(), key,
+            std::make_tuple(attrType, readOnly, displayName, description,
+                            menuPath, currentValue, defaultValue,
+                            std::move(optionsV1)));
+    }
+
+    return tableV1;
+}
 
-static std::uint32_t currentVersion = BIOS_CONFIG_VERSION;
+/** @struct LegacyState
+ *
+ *  @brief Target for decoding a whole-state archive of an earlier release.
+ */
+struct LegacyState
+{
+    Snapshot& snapshot;
+    std::uint32_t version;
+};
 
-/** @brief Function required by Cereal to perform serialization.
+/** @struct LegacyArchive
  *
- *  @tparam Archive - Cereal archive type (binary in this case).
+ *  @brief Source for encoding a whole-state archive of an earlier release.
+ */
+struct LegacyArchive
+{
+    const Snapshot& snapshot;
+    std::uint32_t version;
+};
+
+/** @brief Function required by Cereal to perform deserialization of a
+ *         whole-state archive.
+ *
+ *  @tparam Archive - Cereal archive type (binary in our case).
  *  @param[in] archive - reference to cereal archive.
- *  @param[in] entry- const reference to bios manager object
+ *  @param[out] state - target state and the archive version to decode
  *  @param[in] version - Class version that enables handling a serialized data
  *                       across code levels
  */
 template <class Archive>
-void save(Archive& archive, const Manager& entry,
+void load(Archive& archive, LegacyState& state,
           const std::uint32_t /*version*/)
 {
-    std::uint32_t version = BIOS_CONFIG_VERSION;
-    archive(version);
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-                baseBIOSTable(),
-            entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-                pendingAttributes(),
-            entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-                enableAfterReset(),
-            entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-                credentialBootstrap());
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::
-                BootOrder::bootOrder());
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::
-                BootOrder::pendingBootOrder());
-    archive(entry.getBootOptionValues());
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::
-                SecureBoot::currentBoot());
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::
-                SecureBoot::enable());
-    archive(entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::
-                SecureBoot::mode());
-}
-
-/** @brief Function required by Cereal to perform deserialization.
+    Snapshot& snapshot = state.snapshot;
+    TableImage::BaseTable baseTable;
+    BaseTableV1 baseTableV1;
+
+    lg2::info("Load Bios Config Version: {VERSION}", "VERSION", state.version);
+    if (state.version == legacyVersion3)
+    {
+        archive(state.version);
+        archive(baseTable, snapshot.pendingAttributes,
+                snapshot.enableAfterReset, snapshot.credentialBootstrap);
+    }
+    else if (state.version == legacyVersion2)
+    {
+        archive(state.version);
+        archive(baseTable, snapshot.pendingAttributes,
+                snapshot.enableAfterReset);
+        snapshot.credentialBootstrap = true;
+    }
+    else
+    {
+        archive(baseTableV1, snapshot.pendingAttributes,
+                snapshot.enableAfterReset);
+        baseTable = convertBaseTableV1ToBaseTable(std::move(baseTableV1));
+        snapshot.credentialBootstrap = true;
+    }
+    snapshot.baseTable = TableImage::build(baseTable);
+
+    archive(snapshot.bootOrder);
+    archive(snapshot.pendingBootOrder);
+    archive(snapshot.bootOptions);
+    archive(snapshot.currentBoot);
+    archive(snapshot.enable);
+    archive(snapshot.mode);
+}
+
+/** @brief Function required by Cereal to perform serialization of a
+ *         whole-state archive.
  *
- *  @tparam Archive - Cereal archive type (binary in our case).
+ *  @tparam Archive - Cereal archive type (binary in this case).
  *  @param[in] archive - reference to cereal archive.
- *  @param[out] entry - reference to bios manager object
+ *  @param[in] state - source state and the archive version to encode
  *  @param[in] version - Class version that enables handling a serialized data
  *                       across code levels
  */
 template <class Archive>
-void load(Archive& archive, Manager& entry, const std::uint32_t /*version*/)
+void save(Archive& archive, const LegacyArchive& state,
+          const std::uint32_t /*version*/)
 {
-    Manager::BaseTable baseTable;
-    Manager::BaseTableV1 baseTableV1;
-
-    Manager::PendingAttributes pendingAttrs;
-    bool enableAfterResetFlag;
-    bool credentialBootstrapFlag;
-
-    lg2::info("Load Bios Config Version: {VERSION}", "VERSION", currentVersion);
-    if (currentVersion == BIOS_CONFIG_VERSION)
+    const Snapshot& snapshot = state.snapshot;
+    if (state.version == legacyVersion3)
     {
-        archive(currentVersion);
-        archive(baseTable, pendingAttrs, enableAfterResetFlag,
-                credentialBootstrapFlag);
+        archive(state.version);
+        archive(snapshot.baseTable->table(), snapshot.pendingAttributes,
+                snapshot.enableAfterReset, snapshot.credentialBootstrap);
     }
-    else if (currentVersion == BIOS_CONFIG_VERSION_2)
+    else if (state.version == legacyVersion2)
     {
-        archive(currentVersion);
-        archive(baseTable, pendingAttrs, enableAfterResetFlag);
-        credentialBootstrapFlag = true;
+        archive(state.version);
+        archive(snapshot.baseTable->table(), snapshot.pendingAttributes,
+                snapshot.enableAfterReset);
     }
     else
     {
-        archive(baseTableV1, pendingAttrs, enableAfterResetFlag);
-        baseTable = entry.convertBaseTableV1ToBaseTable(baseTableV1);
-        credentialBootstrapFlag = true;
+        archive(convertBaseTableToBaseTableV1(snapshot.baseTable->table()),
+                snapshot.pendingAttributes, snapshot.enableAfterReset);
     }
 
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-        baseBIOSTable(baseTable, true);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-        pendingAttributes(pendingAttrs, true);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-        enableAfterReset(enableAfterResetFlag, true);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::Manager::
-        credentialBootstrap(credentialBootstrapFlag, true);
+    archive(snapshot.bootOrder);
+    archive(snapshot.pendingBootOrder);
+    archive(snapshot.bootOptions);
+    archive(snapshot.currentBoot);
+    archive(snapshot.enable);
+    archive(snapshot.mode);
+}
+
+namespace journal
+{
+
+/** @brief Functions required by Cereal to (de)serialize the journal delta
+ *         records.
+ *
+ *  @tparam Archive - Cereal archive type (binary in this case).
+ *  @param[in] archive - reference to cereal archive.
+ *  @param[in/out] record - reference to the journal record
+ */
+template <class Archive>
+void serialize(Archive& archive, PendingAttribute& record)
+{
+    archive(record.name, record.value);
+}
+
+template <class Archive>
+void serialize(Archive& /*archive*/, ClearPendingAttributes& /*record*/)
+{}
+
+template <class Archive>
+void serialize(Archive& archive, BootOption& record)
+{
+    archive(record.key, record.values);
+}
+
+template <class Archive>
+void serialize(Archive& archive, DeleteBootOption& record)
+{
+    archive(record.key);
+}
+
+template <class Archive>
+void serialize(Archive& archive, BootOrder& record)
+{
+    archive(record.value);
+}
 
-    Manager::BootOrderType bootOrderValue;
-    archive(bootOrderValue);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::BootOrder::
-        bootOrder(bootOrderValue, true);
+template <class Archive>
+void serialize(Archive& archive, PendingBootOrder& record)
+{
+    archive(record.value);
+}
 
-    Manager::BootOrderType pendingBootOrderValue;
-    archive(pendingBootOrderValue);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::BootOrder::
-        pendingBootOrder(pendingBootOrderValue, true);
+template <class Archive>
+void serialize(Archive& archive, EnableAfterReset& record)
+{
+    archive(record.value);
+}
 
-    Manager::BootOptionsType bootOptionsValues;
-    archive(bootOptionsValues);
-    entry.setBootOptionValues(bootOptionsValues);
+template <class Archive>
+void serialize(Archive& archive, CredentialBootstrap& record)
+{
+    archive(record.value);
+}
 
-    Manager::CurrentBootType currentBootValue;
-    archive(currentBootValue);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::SecureBoot::
-        currentBoot(currentBootValue, true);
+template <class Archive>
+void serialize(Archive& archive, CurrentBoot& record)
+{
+    archive(record.value);
+}
 
-    bool enableValue;
-    archive(enableValue);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::SecureBoot::
-        enable(enableValue, true);
+template <class Archive>
+void serialize(Archive& archive, SecureBootEnable& record)
+{
+    archive(record.value);
+}
 
-    Manager::ModeType modeValue;
-    archive(modeValue);
-    entry.sdbusplus::xyz::openbmc_project::BIOSConfig::server::SecureBoot::mode(
-        modeValue, true);
+template <class Archive>
+void serialize(Archive& archive, SecureBootMode& record)
+{
+    archive(record.value);
 }
 
-void serialize(const Manager& obj, const fs::path& path)
+template <class Archive>
+void serialize(Archive& archive, BaseTableDelta& record)
 {
-    std::ofstream os(path.c_str(), std::ios::out | std::ios::binary);
-    cereal::BinaryOutputArchive oarchive(os);
-    oarchive(obj);
+    archive(record.upserts, record.removals);
 }
 
-bool deserialize(const fs::path& path, Manager& entry)
+template <class Archive>
+void serialize(Archive& archive, DropPendingAttributes& record)
 {
-    try
+    archive(record.names);
+}
+
+template <class Archive>
+void serialize(Archive& archive, GenerationNumber& record)
+{
+    archive(record.generation, record.value);
+}
+
+template <class Archive>
+void serialize(Archive& archive, BootOrderChange& record)
+{
+    archive(record.value, record.pending);
+}
+
+/** @brief The section a journal record belongs to */
+struct SectionOf
+{
+    Section operator()(const PendingAttribute&) const
+    {
+        return Section::pendingAttributes;
+    }
+
+    Section operator()(const ClearPendingAttributes&) const
+    {
+        return Section::pendingAttributes;
+    }
+
+    Section operator()(const BootOption&) const
+    {
+        return Section::bootOptions;
+    }
+
+    Section operator()(const DeleteBootOption&) const
+    {
+        return Section::bootOptions;
+    }
+
+    Section operator()(const BootOrder&) const
+    {
+        return Section::bootOrder;
+    }
+
+    Section operator()(const PendingBootOrder&) const
+    {
+        return Section::bootOrder;
+    }
+
+    Section operator()(const EnableAfterReset&) const
+    {
+        return Section::settings;
+    }
+
+    Section operator()(const CredentialBootstrap&) const
+    {
+        return Section::settings;
+    }
+
+    Section operator()(const CurrentBoot&) const
+    {
+        return Section::secureBoot;
+    }
+
+    Section operator()(const SecureBootEnable&) const
+    {
+        return Section::secureBoot;
+    }
+
+    Section operator()(const SecureBootMode&) const
+    {
+        return Section::secureBoot;
+    }
+
+    Section operator()(const BaseTableDelta&) const
+    {
+        return Section::baseTable;
+    }
+
+    Section operator()(const DropPendingAttributes&) const
+    {
+        return Section::pendingAttributes;
+    }
+
+    Section operator()(const GenerationNumber&) const
+    {
+        return Section::generations;
+    }
+
+    Section operator()(const BootOrderChange&) const
+    {
+        return Section::bootOrder;
+    }
+};
+
+/** @brief Applies replayed journal records on top of the loaded sections.
+ *         BaseBIOSTable deltas patch the image, like they did when they
+ *         were journaled.
+ */
+struct Replay
+{
+    Snapshot& state;
+
+    void operator()(const PendingAttribute& record)
+    {
+        state.pendingAttributes.insert_or_assign(record.name, record.value);
+    }
+
+    void operator()(const ClearPendingAttributes& /*record*/)
+    {
+        state.pendingAttributes.clear();
+    }
+
+    void operator()(const BootOption& record)
     {
-        if (fs::exists(path))
+        state.bootOptions.insert_or_assign(record.key, record.values);
+    }
+
+    void operator()(const DeleteBootOption& record)
+    {
+        state.bootOptions.erase(record.key);
+    }
+
+    void operator()(const BootOrder& record)
+    {
+        state.bootOrder = record.value;
+    }
+
+    void operator()(const PendingBootOrder& record)
+    {
+        state.pendingBootOrder = record.value;
+    }
+
+    void operator()(const EnableAfterReset& record)
+    {
+        state.enableAfterReset = record.value;
+    }
+
+    void operator()(const CredentialBootstrap& record)
+    {
+        state.credentialBootstrap = record.value;
+    }
+
+    void operator()(const CurrentBoot& record)
+    {
+        state.currentBoot = record.value;
+    }
+
+    void operator()(const SecureBootEnable& record)
+    {
+        state.enable = record.value;
+    }
+
+    void operator()(const SecureBootMode& record)
+    {
+        state.mode = record.value;
+    }
+
+    void operator()(const BaseTableDelta& record)
+    {
+        if (!state.baseTable)
         {
-            try
-            {
-                std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
-                cereal::BinaryInputArchive iarchive(is);
-                iarchive(entry);
-            }
-            catch (...)
-            {
-                try
-                {
-                    lg2::error("Trying with old Bios Config Version: {VERSION}",
-                               "VERSION", 2);
-                    std::ifstream is(path.c_str(),
-                                     std::ios::in | std::ios::binary);
-                    cereal::BinaryInputArchive iarchive(is);
-                    currentVersion = BIOS_CONFIG_VERSION_2;
-                    iarchive(entry);
-                }
-                catch (...)
-                {
-                    lg2::error("Trying with old Bios Config Version: {VERSION}",
-                               "VERSION", 1);
-                    std::ifstream is(path.c_str(),
-                                     std::ios::in | std::ios::binary);
-                    cereal::BinaryInputArchive iarchive(is);
-                    currentVersion = BIOS_CONFIG_VERSION_1;
-                    iarchive(entry);
-                }
-            }
-            return true;
+            state.baseTable = TableImage::build({});
         }
-        return false;
+        state.baseTable = state.baseTable->update(record.upserts,
+                                                  record.removals);
     }
-    catch (cereal::Exception& e)
+
+    void operator()(const DropPendingAttributes& record)
     {
-        lg2::error("Cereal failed to serialize: {ERROR}", "ERROR", e);
-        fs::remove(path);
-        return false;
+        for (const auto& name : record.names)
+        {
+            state.pendingAttributes.erase(name);
+        }
     }
-    catch (const std::exception& e)
+
+    void operator()(const GenerationNumber& record)
     {
-        lg2::error("Failed to serialize: {ERROR}", "ERROR", e);
-        fs::remove(path);
-        return false;
+        auto generation = static_cast<size_t>(record.generation);
+        if (generation < generationCount)
+        {
+            state.generations[generation] = record.value;
+        }
+    }
+
+    void operator()(const BootOrderChange& record)
+    {
+        state.bootOrder = record.value;
+        state.pendingBootOrder = record.pending;
+    }
+};
+
+} // namespace journal
+
+/** @struct SectionInfo
+ *
+ *  @brief File name suffix and current format version of a section. The
+ *         version is stored in the slot header and bumped whenever the
+ *         encoding of that section changes.
+ */
+struct SectionInfo
+{
+    const char* name;
+    std::uint32_t version;
+};
+
+static constexpr std::array<SectionInfo, sectionCount> sections = {{
+    {"table", 1},
+    {"pending", 1},
+    {"settings", 1},
+    {"bootorder", 1},
+    {"bootoptions", 1},
+    {"secureboot", 1},
+    {"generations", 1},
+}};
+
+static size_t index(Section section)
+{
+    return static_cast<size_t>(section);
+}
+
+const char* sectionName(Section section)
+{
+    return sections[index(section)].name;
+}
+
+fs::path sectionPath(const fs::path& path, Section section)
+{
+    fs::path p = path;
+    p += ".";
+    p += sectionName(section);
+    return p;
+}
+
+static fs::path suffixed(const fs::path& path, const char* suffix)
+{
+    fs::path p = path;
+    p += suffix;
+    return p;
+}
+
+/** @brief Prefix of the table image file names, followed by the image
+ *         number the table slot refers to.
+ */
+static fs::path tableImagePrefix(const fs::path& path)
+{
+    return suffixed(sectionPath(path, Section::baseTable), ".img.");
+}
+
+static fs::path tableImagePath(const fs::path& path, std::uint64_t image)
+{
+    return suffixed(tableImagePrefix(path), std::to_string(image).c_str());
+}
+
+/** @brief Numbers of the table image files on disk. */
+static std::vector<std::uint64_t> tableImageFiles(const fs::path& path)
+{
+    std::vector<std::uint64_t> images;
+    auto prefix = tableImagePrefix(path).filename().string();
+    std::error_code ec;
+    fs::directory_iterator dir(
+        path.has_parent_path() ? path.parent_path() : fs::path("."), ec);
+    for (; !ec && dir != fs::directory_iterator(); dir.increment(ec))
+    {
+        auto name = dir->path().filename().string();
+        if (!name.starts_with(prefix) || name.size() == prefix.size())
+        {
+            continue;
+        }
+        auto number = std::string_view(name).substr(prefix.size());
+        if (std::ranges::all_of(number,
+                                [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            images.push_back(std::stoull(std::string(number)));
+        }
+    }
+    return images;
+}
+
+/** @brief Whether a slot format of a section can be decoded. */
+static bool supported(Section section, std::uint32_t format)
+{
+    return format == sections[index(section)].version;
+}
+
+/** @brief Encode one section, prefixed with the first journal sequence
+ *         number it does not contain.
+ */
+static std::string encodeSection(const Snapshot& state, Section section,
+                                 std::uint64_t nextSeq)
+{
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    {
+        cereal::BinaryOutputArchive archive(os);
+        archive(nextSeq);
+        switch (section)
+        {
+            case Section::baseTable:
+                // Stored as a table image, see Persistence::writeSection()
+                break;
+            case Section::pendingAttributes:
+                archive(state.pendingAttributes);
+                break;
+            case Section::settings:
+                archive(state.enableAfterReset, state.credentialBootstrap);
+                break;
+            case Section::bootOrder:
+                archive(state.bootOrder, state.pendingBootOrder);
+                break;
+            case Section::bootOptions:
+                archive(state.bootOptions);
+                break;
+            case Section::secureBoot:
+                archive(state.currentBoot, state.enable, state.mode);
+                break;
+            case Section::generations:
+                archive(state.generations);
+                break;
+        }
+    }
+    return std::move(os).str();
+}
+
+/** @brief Decode one section into a state.
+ *
+ *  @return The first journal sequence number the section does not contain.
+ */
+static std::uint64_t decodeSection(Snapshot& state, Section section,
+                                   const std::string& payload)
+{
+    std::istringstream is(payload, std::ios::in | std::ios::binary);
+    cereal::BinaryInputArchive archive(is);
+    std::uint64_t nextSeq;
+    archive(nextSeq);
+    switch (section)
+    {
+        case Section::baseTable:
+            // Stored as a table image, see decodeTable()
+            break;
+        case Section::pendingAttributes:
+            archive(state.pendingAttributes);
+            break;
+        case Section::settings:
+            archive(state.enableAfterReset, state.credentialBootstrap);
+            break;
+        case Section::bootOrder:
+            archive(state.bootOrder, state.pendingBootOrder);
+            break;
+        case Section::bootOptions:
+            archive(state.bootOptions);
+            break;
+        case Section::secureBoot:
+            archive(state.currentBoot, state.enable, state.mode);
+            break;
+        case Section::generations:
+            archive(state.generations);
+            break;
+    }
+    return nextSeq;
+}
+
+/** @brief Decode the table section into a state, opening the table image it
+ *         refers to.
+ *
+ *  @param[in] path - base path of the persisted files
+ *  @param[in] payload - payload of the slot
+ *  @param[out] state - target state
+ *  @param[out] image - number of the table image file the slot refers to
+ *
+ *  @return The first journal sequence number the section does not contain.
+ */
+static std::uint64_t decodeTable(const fs::path& path,
+                                 const std::string& payload, Snapshot& state,
+                                 std::uint64_t& image)
+{
+    std::istringstream is(payload, std::ios::in | std::ios::binary);
+    cereal::BinaryInputArchive archive(is);
+    std::uint64_t seq;
+    archive(seq);
+
+    std::uint32_t checksum;
+    archive(image, checksum);
+    auto table = TableImage::open(tableImagePath(path, image));
+    if (table->checksum() != checksum)
+    {
+        throw std::runtime_error("BaseBIOSTable image does not match");
+    }
+    state.baseTable = std::move(table);
+    return seq;
+}
+
+static std::optional<journal::Record> decodeRecord(const std::string& payload)
+{
+    journal::Record record;
+    try
+    {
+        std::istringstream is(payload, std::ios::in | std::ios::binary);
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(record);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to decode journal record: {ERROR}", "ERROR", e);
+        return std::nullopt;
+    }
+    return record;
+}
+
+/** @brief Determine the version of an unframed biosData file written by
+ *         earlier releases from its first bytes.
+ *
+ *  Every archive starts with the cereal class version. Versions 2 and 3
+ *  follow it with our version field and then the 64-bit size of the
+ *  BaseBIOSTable, version 1 directly with the size of the BaseBIOSTable.
+ *  The layouts only look alike for a version 1 table of two or three
+ *  attributes and an empty table of a later version, only then a second
+ *  decode may be needed.
+ *
+ *  @param[in] path - the unframed biosData file
+ *
+ *  @return The candidate versions, most likely first.
+ */
+static std::vector<std::uint32_t> detectLegacyVersion(const fs::path& path)
+{
+    std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
+    std::array<std::uint32_t, 3> words{};
+    if (!is.read(reinterpret_cast<char*>(words.data()), sizeof(words)))
+    {
+        // Too short for any version, let the decoder report it
+        return {legacyVersion3};
+    }
+
+    auto version = words[1];
+    if (version != legacyVersion2 && version != legacyVersion3)
+    {
+        return {legacyVersion1};
+    }
+    if (words[2] != 0)
+    {
+        return {version};
+    }
+    return {version, legacyVersion1};
+}
+
+/** @brief Load the unframed biosData file written by earlier releases.
+ *
+ *  @return The version that was decoded. Throws std::exception if the file
+ *          cannot be decoded as any of the candidate versions.
+ */
+static std::uint32_t deserializeLegacy(const fs::path& path, Snapshot& state)
+{
+    auto candidates = detectLegacyVersion(path);
+    for (size_t i = 0;; i++)
+    {
+        try
+        {
+            std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
+            cereal::BinaryInputArchive iarchive(is);
+            LegacyState legacy{state, candidates[i]};
+            iarchive(legacy);
+            return candidates[i];
+        }
+        catch (const std::exception& e)
+        {
+            if (i + 1 == candidates.size())
+            {
+                throw;
+            }
+            lg2::error(
+                "Bios Config is not version {VERSION}, trying version {NEXT}: {ERROR}",
+                "VERSION", candidates[i], "NEXT", candidates[i + 1], "ERROR",
+                e);
+        }
+    }
+}
+
+void saveLegacy(const fs::path& path, const Snapshot& state,
+                std::uint32_t version)
+{
+    if (version < legacyVersion1 || version > legacyVersion3)
+    {
+        throw std::invalid_argument("Unknown Bios Config version");
+    }
+
+    std::ostringstream os(std::ios::out | std::ios::binary);
+    {
+        cereal::BinaryOutputArchive oarchive(os);
+        oarchive(LegacyArchive{state, version});
+    }
+    writeFileAtomic(path, std::move(os).str());
+}
+
+/** @brief Remove the table image files that no valid table slot refers to.
+ *
+ *  @param[in] path - base path of the persisted files
+ */
+static void removeStaleTableImages(const fs::path& path)
+{
+    std::vector<std::uint64_t> referenced;
+    for (const auto& slot : readSlots(sectionPath(path, Section::baseTable)))
+    {
+        try
+        {
+            std::istringstream is(slot.payload,
+                                  std::ios::in | std::ios::binary);
+            cereal::BinaryInputArchive archive(is);
+            std::uint64_t seq;
+            std::uint64_t image;
+            archive(seq, image);
+            referenced.push_back(image);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to decode a BaseBIOSTable slot: {ERROR}",
+                       "ERROR", e);
+        }
+    }
+
+    for (auto image : tableImageFiles(path))
+    {
+        if (std::ranges::find(referenced, image) == referenced.end())
+        {
+            std::error_code ec;
+            fs::remove(tableImagePath(path, image), ec);
+        }
+    }
+}
+
+Persistence::Persistence(const fs::path& path, bool repair) :
+    path(path), journalFile(suffixed(path, ".journal")),
+    cleanFile(suffixed(path, ".clean")), repair(repair)
+{}
+
+void Persistence::record(journal::Record record)
+{
+    records.emplace_back(std::move(record));
+}
+
+void Persistence::markDirty(Section section)
+{
+    dirty.set(index(section));
+}
+
+void Persistence::compact()
+{
+    dirty |= journaled;
+}
+
+bool Persistence::pending() const
+{
+    return !records.empty() || dirty.any() || !journalValid;
+}
+
+/** @brief Fingerprint of an encoded section, without the sequence number it
+ *         starts with.
+ */
+static Persistence::Fingerprint payloadFingerprint(std::string_view payload)
+{
+    payload.remove_prefix(sizeof(std::uint64_t));
+    return {payload.size(), crc32c(payload)};
+}
+
+static Persistence::Fingerprint tableFingerprint(const TableImage& table)
+{
+    return {table.data().size(), table.checksum()};
+}
+
+void Persistence::writeSection(Batch& batch, Section section,
+                               std::uint64_t seq) const
+{
+    const auto& info = sections[index(section)];
+    auto& fingerprint = batch.fingerprints[index(section)];
+    // A section with records in the journal is rewritten even when it
+    // matches, the rewrite is what drops those records.
+    bool mayElide = !batch.journaled.test(index(section));
+    std::string payload;
+    Fingerprint contents;
+    if (section == Section::baseTable)
+    {
+        const auto& table = batch.state.baseTable;
+        contents = tableFingerprint(*table);
+        if (mayElide && contents == fingerprint)
+        {
+            batch.elided++;
+            return;
+        }
+
+        // Every image gets a new file, so the images both slots refer to
+        // stay usable until the new slot is written. The one the replaced
+        // slot referred to is only removed afterwards.
+        auto images = tableImageFiles(path);
+        std::uint64_t image =
+            images.empty() ? 0 : *std::ranges::max_element(images) + 1;
+        writeFileAtomic(tableImagePath(path, image), table->data());
+
+        std::ostringstream os(std::ios::out | std::ios::binary);
+        {
+            cereal::BinaryOutputArchive archive(os);
+            archive(seq, image, table->checksum());
+        }
+        payload = std::move(os).str();
+    }
+    else
+    {
+        payload = encodeSection(batch.state, section, seq);
+        contents = payloadFingerprint(payload);
+        if (mayElide && contents == fingerprint)
+        {
+            batch.elided++;
+            return;
+        }
+    }
+
+    auto generation = writeSlot(sectionPath(path, section), info.version,
+                                payload);
+    if (section == Section::baseTable)
+    {
+        removeStaleTableImages(path);
+    }
+    fingerprint = contents;
+    lg2::debug("Persisted Bios Config {SECTION} generation {GENERATION}",
+               "SECTION", info.name, "GENERATION", generation);
+}
+
+std::shared_ptr<Persistence::Batch> Persistence::prepare()
+{
+    if (!pending())
+    {
+        return nullptr;
+    }
+
+    if (!journalValid)
+    {
+        // Records cannot be numbered in a journal that does not line up with
+        // the sections, rewrite what they touch and start the journal over.
+        for (const auto& record : records)
+        {
+            dirty.set(index(std::visit(journal::SectionOf{}, record)));
+        }
+        records.clear();
+        dirty |= journaled;
+    }
+
+    // A section that is rewritten anyway needs no journal records
+    std::erase_if(records, [this](const journal::Record& record) {
+        return dirty.test(index(std::visit(journal::SectionOf{}, record)));
+    });
+
+    auto batch = std::make_shared<Batch>();
+    for (const auto& record : records)
+    {
+        batch->touched.set(index(std::visit(journal::SectionOf{}, record)));
+    }
+    batch->records = std::move(records);
+    records.clear();
+    batch->firstSeq = nextSeq;
+    nextSeq += batch->records.size();
+
+    batch->sections = dirty;
+    dirty.reset();
+
+    batch->journaled = journaled;
+    batch->fingerprints = fingerprints;
+    batch->journalValid = journalValid;
+    batch->journalEmpty = journalEmpty;
+    batch->removeLegacy = legacyFiles;
+    batch->removeClean = cleanMarked;
+    cleanMarked = false;
+    return batch;
+}
+
+void Persistence::write(Batch& batch) const
+{
+    if (batch.removeClean)
+    {
+        // A crash while the batch is written must not find the files clean
+        try
+        {
+            removeFile(cleanFile);
+            batch.cleanRemoved = true;
+        }
+        catch (...)
+        {
+            batch.error = std::current_exception();
+            return;
+        }
+    }
+
+    auto seq = batch.firstSeq + batch.records.size();
+    if (!batch.records.empty())
+    {
+        std::vector<std::string> payloads;
+        payloads.reserve(batch.records.size());
+        for (const auto& record : batch.records)
+        {
+            std::ostringstream os(std::ios::out | std::ios::binary);
+            {
+                cereal::BinaryOutputArchive oarchive(os);
+                oarchive(record);
+            }
+            payloads.emplace_back(std::move(os).str());
+        }
+
+        try
+        {
+            batch.journalSize = appendJournal(journalFile, payloads);
+            batch.appended = true;
+        }
+        catch (const std::exception& e)
+        {
+            // complete() queues the sections that depend on the journal
+            lg2::error("Failed to append to the journal: {ERROR}", "ERROR", e);
+        }
+    }
+
+    try
+    {
+        for (size_t i = 0; i < sectionCount; i++)
+        {
+            if (batch.sections.test(i))
+            {
+                writeSection(batch, static_cast<Section>(i), seq);
+                batch.written.set(i);
+            }
+        }
+
+        auto journaled = batch.journaled;
+        if (batch.appended)
+        {
+            journaled |= batch.touched;
+        }
+        journaled &= ~batch.written;
+
+        // After a failed append the journal is only started over once the
+        // sections it touched are rewritten, by the next batch.
+        bool failed = !batch.records.empty() && !batch.appended;
+        if (!failed && journaled.none() &&
+            (batch.appended || !batch.journalValid || !batch.journalEmpty))
+        {
+            batch.journalSize = resetJournal(journalFile, seq);
+            batch.journalReset = true;
+        }
+
+        if (batch.removeLegacy && batch.written == batch.sections)
+        {
+            // The sections now hold everything the whole-state file had
+            std::error_code ec;
+            fs::remove(path, ec);
+            batch.legacyRemoved = true;
+        }
+    }
+    catch (...)
+    {
+        batch.error = std::current_exception();
+    }
+}
+
+bool Persistence::complete(const Batch& batch)
+{
+    elided += batch.elided;
+    for (size_t i = 0; i < sectionCount; i++)
+    {
+        if (batch.written.test(i))
+        {
+            fingerprints[i] = batch.fingerprints[i];
+        }
+    }
+
+    if (batch.appended)
+    {
+        journaled |= batch.touched;
+        journalEmpty = false;
+        journalSize = batch.journalSize;
+    }
+    else if (!batch.records.empty())
+    {
+        // Part of the batch may have reached the journal, so the sequence
+        // numbers on disk are uncertain. Rewrite every section that depends
+        // on the journal and start it over.
+        dirty |= journaled | batch.touched;
+        journalValid = false;
+    }
+    journaled &= ~batch.written;
+    dirty |= batch.sections & ~batch.written;
+
+    if (batch.journalReset)
+    {
+        journalValid = true;
+        journalEmpty = true;
+        journalSize = batch.journalSize;
+    }
+    if (batch.legacyRemoved)
+    {
+        legacyFiles = false;
+    }
+    if (batch.removeClean && !batch.cleanRemoved)
+    {
+        cleanMarked = true;
+    }
+
+    return journalSize >= JOURNAL_COMPACT_THRESHOLD;
+}
+
+bool Persistence::migrate(Snapshot& state)
+{
+    bool loaded = false;
+
+    // Unframed archive
+    if (fs::exists(path))
+    {
+        try
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto version = deserializeLegacy(path, state);
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start);
+            lg2::info(
+                "Decoded legacy Bios Config version {VERSION} in {DURATION_US} us",
+                "VERSION", version, "DURATION_US", elapsed.count());
+            loaded = true;
+        }
+        catch (const std::exception& e)
+        {
+            // Keep the file for analysis instead of deleting the only copy,
+            // but move it aside so it is not decoded again on every start.
+            lg2::error("Failed to deserialize {PATH}: {ERROR}", "PATH",
+                       path.string(), "ERROR", e);
+            if (repair)
+            {
+                std::error_code ec;
+                fs::rename(path, suffixed(path, ".bad"), ec);
+            }
+        }
+    }
+
+    // Every section is written from the migrated state before the old files
+    // are removed, an interrupted migration starts over on the next start.
+    lg2::info("Migrating Bios Config to persisted sections");
+    nextSeq = 0;
+    dirty.set();
+    journalValid = false;
+    legacyFiles = true;
+    return loaded;
+}
+
+bool Persistence::markClean()
+{
+    if (pending())
+    {
+        return false;
+    }
+    if (!cleanMarked)
+    {
+        writeFileAtomic(cleanFile, {});
+        cleanMarked = true;
+    }
+    return true;
+}
+
+bool Persistence::load(Snapshot& state)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool loaded;
+    const char* source;
+    if (fs::exists(path))
+    {
+        loaded = migrate(state);
+        source = "whole-state file";
+    }
+    else
+    {
+        loaded = loadSections(state);
+        source = "sections";
+    }
+
+    // Whatever this run writes invalidates the marker, drop it right away
+    // so a crash before the next clean shutdown is noticed
+    try
+    {
+        clean = removeFile(cleanFile);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to remove the clean-shutdown marker: {ERROR}",
+                   "ERROR", e);
+        clean = false;
+        // The first batch tries again before it writes anything
+        cleanMarked = true;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    lg2::info("Loaded Bios Config from {SOURCE} in {DURATION_US} us", "SOURCE",
+              source, "DURATION_US", elapsed.count());
+    return loaded;
+}
+
+bool Persistence::loadSections(Snapshot& state)
+{
+    bool loaded = false;
+    std::array<std::uint64_t, sectionCount> sectionSeq{};
+    for (size_t i = 0; i < sectionCount; i++)
+    {
+        auto section = static_cast<Section>(i);
+        const auto& info = sections[i];
+        // The slot checksums already rule out torn or corrupted copies, so
+        // an older slot is only decoded if the newest one cannot be.
+        for (const auto& slot : readSlots(sectionPath(path, section)))
+        {
+            if (!supported(section, slot.format))
+            {
+                lg2::error(
+                    "Unsupported Bios Config {SECTION} format {FORMAT} in generation {GENERATION}",
+                    "SECTION", info.name, "FORMAT", slot.format, "GENERATION",
+                    slot.generation);
+                continue;
+            }
+
+            try
+            {
+                if (section == Section::baseTable)
+                {
+                    std::uint64_t image = 0;
+                    sectionSeq[i] = decodeTable(path, slot.payload, state,
+                                                image);
+                    fingerprints[i] = tableFingerprint(*state.baseTable);
+                }
+                else
+                {
+                    sectionSeq[i] =
+                        decodeSection(state, section, slot.payload);
+                    fingerprints[i] = payloadFingerprint(slot.payload);
+                }
+                loaded = true;
+                break;
+            }
+            catch (const std::exception& e)
+            {
+                lg2::error(
+                    "Failed to deserialize Bios Config {SECTION} generation {GENERATION}: {ERROR}",
+                    "SECTION", info.name, "GENERATION", slot.generation,
+                    "ERROR", e);
+            }
+        }
+    }
+    nextSeq = *std::ranges::max_element(sectionSeq);
+
+    auto contents = readJournal(journalFile, repair);
+    if (!contents)
+    {
+        journalValid = false;
+        return loaded;
+    }
+
+    journal::Replay replay{state};
+    std::uint64_t seq = contents->base;
+    size_t applied = 0;
+    journalValid = true;
+    for (const auto& payload : contents->records)
+    {
+        auto record = decodeRecord(payload);
+        if (!record)
+        {
+            // The rest of the journal cannot be trusted, rewrite the
+            // sections it touched and start it over.
+            journalValid = false;
+            break;
+        }
+
+        auto section = index(std::visit(journal::SectionOf{}, *record));
+        if (seq >= sectionSeq[section])
+        {
+            try
+            {
+                std::visit(replay, *record);
+            }
+            catch (const std::exception& e)
+            {
+                // Handled like an undecodable record, the section is
+                // rewritten from what could be replayed
+                lg2::error("Failed to replay journal record {SEQ}: {ERROR}",
+                           "SEQ", seq, "ERROR", e);
+                journalValid = false;
+                dirty.set(section);
+                break;
+            }
+            journaled.set(section);
+            applied++;
+        }
+        seq++;
+    }
+
+    seq = contents->base + contents->records.size();
+    if (seq < nextSeq)
+    {
+        // Numbering does not line up with the sections, start over
+        journalValid = false;
+    }
+    nextSeq = std::max(nextSeq, seq);
+    journalSize = contents->size;
+    journalEmpty = contents->records.empty();
+
+    lg2::info("Replayed {COUNT} journal records", "COUNT", applied);
+    return loaded || applied != 0;
+}
+
+std::vector<std::string> Persistence::verify() const
+{
+    std::vector<std::string> problems;
+    auto report = [&problems](const fs::path& file, const std::string& what) {
+        problems.emplace_back(file.string() + ": " + what);
+    };
+    // readSlots() skips the slots that fail their checksums
+    auto checkSlots = [&report](const fs::path& file) {
+        auto slots = readSlots(file);
+        size_t present = fs::exists(suffixed(file, ".a")) +
+                         fs::exists(suffixed(file, ".b"));
+        if (present > slots.size())
+        {
+            report(file, std::to_string(present - slots.size()) +
+                             " slot(s) failed validation");
+        }
+        return slots;
+    };
+
+    if (fs::exists(path))
+    {
+        try
+        {
+            Snapshot state;
+            deserializeLegacy(path, state);
+        }
+        catch (const std::exception& e)
+        {
+            report(path, e.what());
+        }
+    }
+
+    for (size_t i = 0; i < sectionCount; i++)
+    {
+        auto section = static_cast<Section>(i);
+        auto file = sectionPath(path, section);
+        for (const auto& slot : checkSlots(file))
+        {
+            auto generation = "generation " + std::to_string(slot.generation);
+            if (!supported(section, slot.format))
+            {
+                report(file, generation + ": unsupported format " +
+                                 std::to_string(slot.format));
+                continue;
+            }
+
+            try
+            {
+                Snapshot state;
+                std::uint64_t image = 0;
+                if (section == Section::baseTable)
+                {
+                    decodeTable(path, slot.payload, state, image);
+                }
+                else
+                {
+                    decodeSection(state, section, slot.payload);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                report(file, generation + ": " + e.what());
+            }
+        }
+    }
+
+    if (fs::exists(journalFile))
+    {
+        auto contents = readJournal(journalFile, false);
+        if (!contents)
+        {
+            report(journalFile, "invalid header");
+            return problems;
+        }
+
+        std::error_code ec;
+        auto size = fs::file_size(journalFile, ec);
+        if (!ec && size > contents->size)
+        {
+            report(journalFile, std::to_string(size - contents->size) +
+                                    " bytes of torn records");
+        }
+        for (size_t i = 0; i < contents->records.size(); i++)
+        {
+            if (!decodeRecord(contents->records[i]))
+            {
+                report(journalFile,
+                       "record " + std::to_string(i) + " cannot be decoded");
+                break;
+            }
+        }
+    }
+    return problems;
+}
+
+void Persistence::save(const Snapshot& state)
+{
+    dirty.set();
+    auto batch = prepare();
+    batch->state = state;
+    write(*batch);
+    complete(*batch);
+    if (batch->error)
+    {
+        std::rethrow_exception(batch->error);
     }
 }
 
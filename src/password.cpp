@@ -15,10 +15,17 @@
 */
 #include "password.hpp"
 
+#include "persist_file.hpp"
 #include "rfutility.hpp"
 #include "xyz/openbmc_project/BIOSConfig/Common/error.hpp"
 #include "xyz/openbmc_project/Common/error.hpp"
 
+#include <fcntl.h>
+#include <openssl/crypto.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <boost/algorithm/hex.hpp>
 #include <boost/asio.hpp>
 #include <phosphor-logging/elog-errors.hpp>
@@ -26,222 +33,407 @@
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <span>
+#include <string_view>
 
 namespace bios_config_pwd
 {
 using namespace sdbusplus::xyz::openbmc_project::Common::Error;
 using namespace sdbusplus::xyz::openbmc_project::BIOSConfig::Common::Error;
 
-bool Password::compareDigest(const EVP_MD* digestFunc, size_t digestLen,
-                             const std::array<uint8_t, maxHashSize>& expected,
-                             const std::array<uint8_t, maxSeedSize>& seed,
-                             const std::string& rawData)
+/** @brief Period of the timer that measures the io loop lag while a
+ *         password is hashed.
+ */
+constexpr auto lagProbeInterval = std::chrono::milliseconds(5);
+
+std::array<uint8_t, maxHashSize> Password::hash(const SeedData& data,
+                                                const std::string& password)
 {
-    std::vector<uint8_t> output(digestLen);
-    unsigned int hashLen = digestLen;
-
-    if (!PKCS5_PBKDF2_HMAC(reinterpret_cast<const char*>(rawData.c_str()),
-                           rawData.length() + 1,
-                           reinterpret_cast<const unsigned char*>(seed.data()),
-                           seed.size(), iterValue, digestFunc, hashLen,
-                           output.data()))
+    std::array<uint8_t, maxHashSize> output{};
+    try
     {
-        lg2::error("Generate PKCS5_PBKDF2_HMAC Integrity Check Value failed");
-        throw InternalFailure();
+        // The terminating NUL is part of the hashed data, as it has always
+        // been, or the stored hashes would no longer match
+        kdf::derive(data.params,
+                    {reinterpret_cast<const uint8_t*>(password.c_str()),
+                     password.length() + 1},
+                    data.seed,
+                    std::span(output).first(data.params.length));
     }
-
-    if (std::memcmp(output.data(), expected.data(),
-                    output.size() * sizeof(uint8_t)) == 0)
+    catch (const std::exception& e)
     {
-        return true;
+        lg2::error("Password hashing failed: {ERROR}", "ERROR", e);
+        throw InternalFailure();
     }
-
-    return false;
+    return output;
 }
 
-bool Password::isMatch(const std::array<uint8_t, maxHashSize>& expected,
-                       const std::array<uint8_t, maxSeedSize>& seed,
-                       const std::string& rawData, const std::string& algo)
+bool Password::isMatch(const SeedData& data,
+                       const std::array<uint8_t, maxHashSize>& expected,
+                       const std::string& rawData)
 {
-    lg2::error("isMatch");
+    auto output = hash(data, rawData);
+    return CRYPTO_memcmp(output.data(), expected.data(),
+                         data.params.length) == 0;
+}
 
-    if (algo == "SHA256")
+Password::SeedData Password::getParam() const
+{
+    SeedData data;
+    int fd = ::open(seedFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
     {
-        return compareDigest(EVP_sha256(), SHA256_DIGEST_LENGTH, expected, seed,
-                             rawData);
+        lg2::debug("Cannot open file stream");
+        throw InternalFailure();
     }
 
-    if (algo == "SHA384")
+    // Stamp the descriptor that is read, so the stamp matches the contents
+    // even if the file is replaced meanwhile
+    struct stat st{};
+    std::string contents;
+    bool ok = ::fstat(fd, &st) == 0;
+    while (ok)
     {
-        return compareDigest(EVP_sha384(), SHA384_DIGEST_LENGTH, expected, seed,
-                             rawData);
+        char buffer[4096];
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            ok = n == 0;
+            break;
+        }
+        contents.append(buffer, n);
     }
+    ::close(fd);
+    if (!ok)
+    {
+        lg2::error("Failed to read {PATH}: {ERRNO}", "PATH", seedFile,
+                   "ERRNO", errno);
+        throw InternalFailure();
+    }
+    data.stamp = stampOf(st);
 
-    return false;
-}
-
-bool Password::getParam(std::array<uint8_t, maxHashSize>& orgUsrPwdHash,
-                        std::array<uint8_t, maxHashSize>& orgAdminPwdHash,
-                        std::array<uint8_t, maxSeedSize>& seed,
-                        std::string& hashAlgo)
-{
     try
     {
-        nlohmann::json json = nullptr;
-        std::ifstream ifs(seedFile.c_str());
-        if (ifs.is_open())
+        data.json = nlohmann::json::parse(contents, nullptr, false);
+        if (data.json.is_discarded())
         {
-            try
-            {
-                json = nlohmann::json::parse(ifs, nullptr, false);
-            }
-            catch (const nlohmann::json::parse_error& e)
-            {
-                lg2::error("Failed to parse JSON file: {ERROR}", "ERROR", e);
-                return false;
-            }
+            throw InternalFailure();
+        }
+        data.orgUsrPwdHash = data.json["UserPwdHash"];
+        data.orgAdminPwdHash = data.json["AdminPwdHash"];
+        data.seed = data.json["Seed"];
 
-            if (!json.is_discarded())
-            {
-                orgUsrPwdHash = json["UserPwdHash"];
-                orgAdminPwdHash = json["AdminPwdHash"];
-                seed = json["Seed"];
-                hashAlgo = json["HashAlgo"];
-            }
+        auto hashAlgo = data.json["HashAlgo"].get<std::string>();
+        auto algorithm = kdf::parseAlgorithm(hashAlgo);
+        if (!algorithm)
+        {
+            // No password can match a hash of an unknown algorithm
+            lg2::error("Unknown BIOS password hash algorithm {ALGO}", "ALGO",
+                       hashAlgo);
+            throw InvalidCurrentPassword();
+        }
+        auto& params = data.params;
+        params = kdf::defaults(*algorithm);
+        params.iterations = data.json.value("Iterations", params.iterations);
+        params.memoryKiB = data.json.value("MemoryKiB", params.memoryKiB);
+        params.blockSize = data.json.value("BlockSize", params.blockSize);
+        params.parallelism = data.json.value("Parallelism",
+                                             params.parallelism);
+        params.length = data.json.value("HashLength", params.length);
+        if (params.length == 0 || params.length > maxHashSize)
+        {
+            lg2::error("Invalid BIOS password hash length {LENGTH}", "LENGTH",
+                       params.length);
+            throw InternalFailure();
         }
     }
-    catch (nlohmann::detail::exception& e)
+    catch (const nlohmann::detail::exception& e)
     {
         lg2::error("Failed to parse JSON file: {ERROR}", "ERROR", e);
-        return false;
+        throw InternalFailure();
     }
-
-    return true;
+    return data;
 }
 
-bool Password::verifyIntegrityCheck(std::string& newPassword,
-                                    std::array<uint8_t, maxSeedSize>& seed,
-                                    unsigned int mdLen,
-                                    const EVP_MD* digestFunc)
+Password::Stamp Password::stampOf(const struct stat& st)
 {
-    mNewPwdHash.fill(0);
+    return {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+            static_cast<int64_t>(st.st_size),
+            static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                st.st_mtim.tv_nsec};
+}
 
-    if (!PKCS5_PBKDF2_HMAC(reinterpret_cast<const char*>(newPassword.c_str()),
-                           newPassword.length() + 1,
-                           reinterpret_cast<const unsigned char*>(seed.data()),
-                           seed.size(), iterValue, digestFunc, mdLen,
-                           mNewPwdHash.data()))
+std::optional<Password::Stamp> Password::seedStamp() const
+{
+    struct stat st{};
+    if (::stat(seedFile.c_str(), &st) < 0)
     {
-        lg2::error("Verify PKCS5_PBKDF2_HMAC Integrity Check failed");
-        return false;
+        return std::nullopt;
     }
-
-    return true;
+    return stampOf(st);
 }
 
-void Password::verifyPassword(std::string userName, std::string currentPassword,
-                              std::string newPassword)
+std::array<uint8_t, maxHashSize>
+    Password::verifyPassword(const SeedData& data, const std::string& userName,
+                             const std::string& currentPassword,
+                             const std::string& newPassword)
 {
-    if (fs::exists(seedFile.c_str()))
+    if (userName == "AdminPassword")
     {
-        std::array<uint8_t, maxHashSize> orgUsrPwdHash;
-        std::array<uint8_t, maxHashSize> orgAdminPwdHash;
-        std::array<uint8_t, maxSeedSize> seed;
-        std::string hashAlgo = "";
-
-        if (getParam(orgUsrPwdHash, orgAdminPwdHash, seed, hashAlgo))
+        if (!isMatch(data, data.orgAdminPwdHash, currentPassword))
         {
-            if (orgUsrPwdHash.empty() || orgAdminPwdHash.empty() ||
-                seed.empty() || hashAlgo.empty())
-            {
-                return;
-            }
+            throw InvalidCurrentPassword();
         }
-        else
+    }
+    else
+    {
+        if (!isMatch(data, data.orgUsrPwdHash, currentPassword))
         {
-            throw InternalFailure();
+            throw InvalidCurrentPassword();
         }
+    }
 
-        if (userName == "AdminPassword")
+    return hash(data, newPassword);
+}
+
+void Password::changePassword(std::shared_ptr<const SeedData>& data,
+                              const std::string& userName,
+                              const std::string& currentPassword,
+                              const std::string& newPassword) const
+{
+    if (!data)
+    {
+        if (!fs::exists(seedFile))
         {
-            if (!isMatch(orgAdminPwdHash, seed, currentPassword, hashAlgo))
-            {
-                throw InvalidCurrentPassword();
-            }
+            throw InternalFailure();
         }
-        else
+        data = std::make_shared<SeedData>(getParam());
+    }
+
+    auto newPwdHash = verifyPassword(*data, userName, currentPassword,
+                                     newPassword);
+
+    auto updated = std::make_shared<SeedData>(*data);
+    updated->json["AdminPwdHash"] = newPwdHash;
+    updated->json["IsAdminPwdChanged"] = true;
+    updated->orgAdminPwdHash = newPwdHash;
+
+    try
+    {
+        bios_config::writeFileAtomic(seedFile, updated->json.dump());
+    }
+    catch (const std::system_error& e)
+    {
+        lg2::error("Failed to write {PATH}: {ERROR}", "PATH", seedFile,
+                   "ERROR", e);
+        // The file may or may not have been replaced
+        data.reset();
+        throw InternalFailure();
+    }
+
+    auto stamp = seedStamp();
+    if (stamp)
+    {
+        updated->stamp = *stamp;
+        data = std::move(updated);
+    }
+    else
+    {
+        data.reset();
+    }
+}
+
+void Password::changePassword(boost::asio::yield_context yield,
+                              std::string userName,
+                              std::string currentPassword,
+                              std::string newPassword)
+{
+    lg2::debug("BIOS config changePassword");
+    auto error = boost::asio::async_initiate<boost::asio::yield_context,
+                                             void(std::exception_ptr)>(
+        [&](auto handler) {
+        calls.emplace_back(std::move(userName), std::move(currentPassword),
+                           std::move(newPassword), std::move(handler));
+        startNext();
+    }, yield);
+
+    if (error)
+    {
+        try
         {
-            if (!isMatch(orgUsrPwdHash, seed, currentPassword, hashAlgo))
-            {
-                throw InvalidCurrentPassword();
-            }
+            std::rethrow_exception(error);
         }
-        if (hashAlgo == "SHA256")
+        catch (const sdbusplus::exception::exception&)
         {
-            if (!verifyIntegrityCheck(newPassword, seed, 32, EVP_sha256()))
-            {
-                throw InternalFailure();
-            }
+            throw;
         }
-        if (hashAlgo == "SHA384")
+        catch (const std::exception& e)
         {
-            if (!verifyIntegrityCheck(newPassword, seed, 48, EVP_sha384()))
-            {
-                throw InternalFailure();
-            }
+            lg2::error("ChangePassword failed: {ERROR}", "ERROR", e);
+            throw InternalFailure();
         }
+    }
+
+    // send redfish event
+    // Every change is reported, the masked value is always the same
+    bios_config::sendRedfishEvent("BiosPassword", "****", objectPathPwd,
+                                  false);
+}
+
+void Password::startNext()
+{
+    if (busy || calls.empty())
+    {
         return;
     }
-    throw InternalFailure();
+    busy = true;
+
+    const auto& call = calls.front();
+    callStart = std::chrono::steady_clock::now();
+    maxLag = {};
+    probeLag();
+
+    // Shared by the job and its completion, the job replaces the copy with
+    // what the file holds once it is done
+    auto data = std::make_shared<std::shared_ptr<const SeedData>>(
+        seedWatch.is_open() ? seedCache : nullptr);
+    worker.post(
+        [this, data, userName = call.userName,
+         currentPassword = call.currentPassword,
+         newPassword = call.newPassword]() {
+        changePassword(*data, userName, currentPassword, newPassword);
+    }, [this, data, epoch = seedEpoch](std::exception_ptr error) {
+        // Keep the result unless the file changed while the job ran
+        if (epoch == seedEpoch && seedWatch.is_open())
+        {
+            seedCache = *data;
+        }
+        changePasswordDone(error);
+    });
 }
-void Password::changePassword(std::string userName, std::string currentPassword,
-                              std::string newPassword)
+
+void Password::changePasswordDone(std::exception_ptr error)
 {
-    lg2::debug("BIOS config changePassword");
-    verifyPassword(userName, currentPassword, newPassword);
+    lagProbe.cancel();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - callStart);
+    lg2::info(
+        "ChangePassword took {DURATION_US} us on the worker, io loop lag stayed below {LAG_US} us",
+        "DURATION_US", elapsed.count(), "LAG_US",
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            maxLag + lagProbeInterval)
+            .count());
+
+    auto call = std::move(calls.front());
+    calls.pop_front();
+    busy = false;
+
+    // Resumed from the io loop, not from within this call
+    boost::asio::post(systemBus->get_io_context(),
+                      [done = std::move(call.done), error]() mutable {
+        done(error);
+    });
+    startNext();
+}
 
-    std::ifstream fs(seedFile.c_str());
-    nlohmann::json json = nullptr;
+void Password::probeLag()
+{
+    probeDeadline = std::chrono::steady_clock::now() + lagProbeInterval;
+    lagProbe.expires_at(probeDeadline);
+    lagProbe.async_wait([this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        maxLag = std::max(maxLag,
+                          std::chrono::steady_clock::now() - probeDeadline);
+        probeLag();
+    });
+}
 
-    if (fs.is_open())
+void Password::watchSeedFile()
+{
+    int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
     {
-        try
+        lg2::error("Failed to create an inotify instance: {ERRNO}", "ERRNO",
+                   errno);
+        return;
+    }
+    if (::inotify_add_watch(fd, seedFile.parent_path().c_str(),
+                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                IN_CREATE | IN_DELETE) < 0)
+    {
+        lg2::error("Failed to watch {PATH}: {ERRNO}", "PATH",
+                   seedFile.parent_path(), "ERRNO", errno);
+        ::close(fd);
+        return;
+    }
+    seedWatch.assign(fd);
+    readSeedEvents();
+}
+
+void Password::readSeedEvents()
+{
+    seedWatch.async_read_some(
+        boost::asio::buffer(seedEvents),
+        [this](const boost::system::error_code& ec, size_t length) {
+        if (ec)
         {
-            json = nlohmann::json::parse(fs, nullptr, false);
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                lg2::error("Failed to read seedData events: {ERROR}", "ERROR",
+                           ec.message());
+                seedWatch.close();
+                seedCache.reset();
+            }
+            return;
         }
-        catch (const nlohmann::json::parse_error& e)
+
+        bool touched = false;
+        for (size_t offset = 0; offset + sizeof(inotify_event) <= length;)
         {
-            lg2::error("Failed to parse JSON file: {ERROR}", "ERROR", e);
-            throw InternalFailure();
+            inotify_event event{};
+            std::memcpy(&event, seedEvents.data() + offset, sizeof(event));
+            const char* name = seedEvents.data() + offset + sizeof(event);
+            if ((event.mask & IN_Q_OVERFLOW) ||
+                (event.len > 0 && seedFile.filename() == name))
+            {
+                touched = true;
+            }
+            offset += sizeof(event) + event.len;
         }
 
-        if (json.is_discarded())
+        // Our own rewrite shows up here too, it leaves the file at the
+        // version that is already cached
+        if (touched && seedCache && seedStamp() != seedCache->stamp)
         {
-            throw InternalFailure();
+            lg2::debug("seedData changed, dropping the cached copy");
+            seedCache.reset();
+            seedEpoch++;
         }
-        json["AdminPwdHash"] = mNewPwdHash;
-        json["IsAdminPwdChanged"] = true;
-
-        std::ofstream ofs(seedFile.c_str(), std::ios::out);
-        const auto& writeData = json.dump();
-        ofs << writeData;
-        ofs.close();
-        // send redfish event
-        bios_config::sendRedfishEvent("BiosPassword", "****", objectPathPwd);
-    }
-    else
-    {
-        lg2::debug("Cannot open file stream");
-        throw InternalFailure();
-    }
+        else if (touched && !seedCache)
+        {
+            seedEpoch++;
+        }
+        readSeedEvents();
+    });
 }
+
 Password::Password(sdbusplus::asio::object_server& objectServer,
                    std::shared_ptr<sdbusplus::asio::connection>& systemBus) :
-    sdbusplus::xyz::openbmc_project::BIOSConfig::server::Password(
-        *systemBus, objectPathPwd),
-    objServer(objectServer), systemBus(systemBus)
+    objServer(objectServer), systemBus(systemBus),
+    lagProbe(systemBus->get_io_context()), worker(systemBus->get_io_context()),
+    seedWatch(systemBus->get_io_context())
 {
     lg2::debug("BIOS config password is running");
     try
@@ -255,6 +447,21 @@ Password::Password(sdbusplus::asio::object_server& objectServer,
         lg2::error("Failed to parse JSON file: {ERROR}", "ERROR", e);
         throw InternalFailure();
     }
+
+    watchSeedFile();
+
+    pwdInterface = objServer.add_interface(objectPathPwd, Base::interface);
+    pwdInterface->register_property(
+        "PasswordInitialized", false,
+        sdbusplus::asio::PropertyPermission::readWrite);
+    pwdInterface->register_method(
+        "ChangePassword",
+        [this](boost::asio::yield_context yield, std::string userName,
+               std::string currentPassword, std::string newPassword) {
+        changePassword(yield, std::move(userName), std::move(currentPassword),
+                       std::move(newPassword));
+    });
+    pwdInterface->initialize();
 }
 
 } // namespace bios_config_pwd
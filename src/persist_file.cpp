@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "persist_file.hpp"
+
+#include "crc32c.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <system_error>
+
+namespace bios_config
+{
+
+namespace
+{
+
+constexpr uint32_t slotMagic = 0x544c5342; // "BSLT"
+constexpr std::array<const char*, 2> slotSuffix = {".a", ".b"};
+
+/** @brief On-disk slot header, stored in host byte order */
+struct SlotHeader
+{
+    uint32_t magic;
+    uint32_t format;
+    uint64_t generation;
+    uint64_t length;
+    uint32_t payloadCrc;
+    /** @brief CRC32C over all preceding header fields */
+    uint32_t headerCrc;
+};
+static_assert(sizeof(SlotHeader) == 32);
+
+uint32_t headerChecksum(const SlotHeader& header)
+{
+    return crc32c(std::string_view(reinterpret_cast<const char*>(&header),
+                                   offsetof(SlotHeader, headerCrc)));
+}
+
+fs::path slotPath(const fs::path& path, size_t index)
+{
+    fs::path p = path;
+    p += slotSuffix[index];
+    return p;
+}
+
+[[noreturn]] void throwErrno(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/** @brief Read and check only the header of a slot */
+std::optional<SlotHeader> readHeader(const fs::path& path)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    SlotHeader header{};
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != slotMagic || header.headerCrc != headerChecksum(header))
+    {
+        return std::nullopt;
+    }
+    return header;
+}
+
+std::optional<Slot> readSlot(const fs::path& path)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    if (!is.is_open())
+    {
+        return std::nullopt;
+    }
+
+    std::string data{std::istreambuf_iterator<char>(is),
+                     std::istreambuf_iterator<char>()};
+    if (data.size() < sizeof(SlotHeader))
+    {
+        lg2::error("Persisted slot {PATH} is truncated", "PATH",
+                   path.string());
+        return std::nullopt;
+    }
+
+    SlotHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != slotMagic || header.headerCrc != headerChecksum(header))
+    {
+        lg2::error("Persisted slot {PATH} has an invalid header", "PATH",
+                   path.string());
+        return std::nullopt;
+    }
+
+    std::string_view payload(data);
+    payload.remove_prefix(sizeof(header));
+    if (payload.size() != header.length ||
+        crc32c(payload) != header.payloadCrc)
+    {
+        lg2::error("Persisted slot {PATH} failed the payload checksum", "PATH",
+                   path.string());
+        return std::nullopt;
+    }
+
+    data.erase(0, sizeof(header));
+    return Slot{header.format, header.generation, std::move(data)};
+}
+
+void writeAll(int fd, std::string_view data, const fs::path& path)
+{
+    while (!data.empty())
+    {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throwErrno("write " + path.string());
+        }
+        data.remove_prefix(written);
+    }
+}
+
+void syncDirectory(const fs::path& dir)
+{
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throwErrno("open " + dir.string());
+    }
+    int rc = ::fsync(fd);
+    ::close(fd);
+    if (rc < 0)
+    {
+        throwErrno("fsync " + dir.string());
+    }
+}
+
+void replaceFile(const fs::path& path,
+                 std::initializer_list<std::string_view> parts)
+{
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    0600);
+    if (fd < 0)
+    {
+        throwErrno("open " + tmp.string());
+    }
+
+    try
+    {
+        for (const auto& part : parts)
+        {
+            writeAll(fd, part, tmp);
+        }
+        if (::fsync(fd) < 0)
+        {
+            throwErrno("fsync " + tmp.string());
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+
+    if (::close(fd) < 0 || ::rename(tmp.c_str(), path.c_str()) < 0)
+    {
+        int err = errno;
+        ::unlink(tmp.c_str());
+        throw std::system_error(err, std::generic_category(),
+                                "replace " + path.string());
+    }
+
+    syncDirectory(path.has_parent_path() ? path.parent_path() : ".");
+}
+
+} // namespace
+
+std::vector<Slot> readSlots(const fs::path& path)
+{
+    std::vector<Slot> slots;
+    for (size_t i = 0; i < slotSuffix.size(); i++)
+    {
+        auto slot = readSlot(slotPath(path, i));
+        if (slot)
+        {
+            slots.emplace_back(std::move(*slot));
+        }
+    }
+
+    std::ranges::sort(slots, std::ranges::greater{}, &Slot::generation);
+    return slots;
+}
+
+uint64_t writeSlot(const fs::path& path, uint32_t format,
+                   std::string_view payload)
+{
+    // Overwrite the slot that does not hold the newest generation
+    uint64_t newest = 0;
+    size_t target = 0;
+    for (size_t i = 0; i < slotSuffix.size(); i++)
+    {
+        auto header = readHeader(slotPath(path, i));
+        if (header && header->generation >= newest)
+        {
+            newest = header->generation;
+            target = (i + 1) % slotSuffix.size();
+        }
+    }
+
+    SlotHeader header{};
+    header.magic = slotMagic;
+    header.format = format;
+    header.generation = newest + 1;
+    header.length = payload.size();
+    header.payloadCrc = crc32c(payload);
+    header.headerCrc = headerChecksum(header);
+
+    replaceFile(slotPath(path, target),
+                {std::string_view(reinterpret_cast<const char*>(&header),
+                                  sizeof(header)),
+                 payload});
+    return header.generation;
+}
+
+void writeFileAtomic(const fs::path& path, std::string_view data)
+{
+    replaceFile(path, {data});
+}
+
+bool removeFile(const fs::path& path)
+{
+    if (::unlink(path.c_str()) < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return false;
+        }
+        throwErrno("unlink " + path.string());
+    }
+
+    syncDirectory(path.has_parent_path() ? path.parent_path() : ".");
+    return true;
+}
+
+} // namespace bios_config
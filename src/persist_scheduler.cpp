@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "persist_scheduler.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+
+namespace bios_config
+{
+
+PersistScheduler::PersistScheduler(boost::asio::io_context& io,
+                                   FlushHandler handler,
+                                   std::chrono::milliseconds quietPeriod,
+                                   std::chrono::milliseconds maxDelay) :
+    timer(io),
+    handler(std::move(handler)), quietPeriod(quietPeriod), maxDelay(maxDelay)
+{}
+
+void PersistScheduler::markDirty()
+{
+    if (!isDirty)
+    {
+        isDirty = true;
+        firstDirty = std::chrono::steady_clock::now();
+    }
+
+    if (maxDelay.count() == 0)
+    {
+        flush();
+        return;
+    }
+
+    arm(std::min(std::chrono::steady_clock::now() + quietPeriod,
+                 firstDirty + maxDelay));
+}
+
+void PersistScheduler::arm(std::chrono::steady_clock::time_point deadline)
+{
+    timer.expires_at(deadline);
+    timer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        flush();
+    });
+}
+
+void PersistScheduler::flush()
+{
+    if (!isDirty)
+    {
+        return;
+    }
+
+    timer.cancel();
+    isDirty = false;
+
+    try
+    {
+        handler();
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to persist BIOS config: {ERROR}", "ERROR", e);
+        retry();
+    }
+}
+
+void PersistScheduler::retry()
+{
+    if (!isDirty)
+    {
+        isDirty = true;
+        firstDirty = std::chrono::steady_clock::now();
+    }
+
+    if (maxDelay.count() != 0)
+    {
+        arm(std::chrono::steady_clock::now() + maxDelay);
+    }
+}
+
+} // namespace bios_config
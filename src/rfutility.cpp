@@ -14,15 +14,196 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "config.h"
+
 #include "rfutility.hpp"
 
-#include "asio_connection.hpp"
+#include "event_limiter.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <phosphor-logging/lg2.hpp>
 
-#include <phosphor-logging/redfish_event_log.hpp>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace bios_config
 {
 
+namespace
+{
+
+constexpr auto loggingService = "xyz.openbmc_project.Logging";
+constexpr auto loggingPath = "/xyz/openbmc_project/logging";
+constexpr auto loggingCreate = "xyz.openbmc_project.Logging.Create";
+constexpr auto propertyValueModified = "Base.1.15.PropertyValueModified";
+constexpr auto informational =
+    "xyz.openbmc_project.Logging.Entry.Level.Informational";
+
+/** @brief Events queued within one io loop tick beyond this are dropped,
+ *         so a burst cannot pile up calls to an unresponsive logging service
+ */
+constexpr size_t maxQueuedEvents = 64;
+
+struct Event
+{
+    std::string propertyName;
+    std::string propertyValue;
+    std::string objectPath;
+};
+
+using LimiterKey = std::pair<std::string, std::string>;
+
+struct EventQueue
+{
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    std::vector<Event> events;
+    /** @brief A drain is posted to the io loop */
+    bool scheduled = false;
+    size_t dropped = 0;
+    /** @brief Keyed by property name and object path. The call sites name a
+     *         fixed set of properties and objects, so this stays small.
+     */
+    std::map<LimiterKey, EventLimiter> limiters;
+    /** @brief Sends the trailing values */
+    std::optional<boost::asio::steady_timer> timer;
+    RedfishEventStats stats;
+};
+
+EventQueue& eventQueue()
+{
+    static EventQueue queue;
+    return queue;
+}
+
+void drainEvents()
+{
+    auto& queue = eventQueue();
+    queue.scheduled = false;
+    auto events = std::move(queue.events);
+    queue.events.clear();
+    if (queue.dropped != 0)
+    {
+        lg2::error(
+            "Dropped {COUNT} Redfish events of one batch, the latest value of each property follows",
+            "COUNT", queue.dropped);
+        queue.dropped = 0;
+    }
+
+    for (auto& event : events)
+    {
+        std::map<std::string, std::string> additionalData = {
+            {"REDFISH_MESSAGE_ID", propertyValueModified},
+            {"REDFISH_MESSAGE_ARGS",
+             event.propertyName + "," + event.propertyValue},
+            {"REDFISH_ORIGIN_OF_CONDITION", event.objectPath}};
+        queue.conn->async_method_call(
+            [propertyName = std::move(event.propertyName)](
+                const boost::system::error_code& ec) {
+            auto& stats = eventQueue().stats;
+            if (ec)
+            {
+                stats.failed++;
+                lg2::error("Failed to log the Redfish event of {PROPERTY}: "
+                           "{ERROR}",
+                           "PROPERTY", propertyName, "ERROR", ec.message());
+                return;
+            }
+            stats.sent++;
+        }, loggingService, loggingPath, loggingCreate, "Create",
+            propertyValueModified, informational, additionalData);
+    }
+}
+
+/** @brief Queue an event that has a token and room in the queue. */
+void queueEvent(EventQueue& queue, const LimiterKey& key,
+                EventLimiter& limiter, const std::string& propertyValue)
+{
+    auto limited = limiter.sent(propertyValue);
+    if (limited != 0)
+    {
+        lg2::info("Suppressed {COUNT} Redfish events of {PROPERTY} on {PATH}",
+                  "COUNT", limited, "PROPERTY", key.first, "PATH",
+                  key.second);
+    }
+
+    queue.events.emplace_back(key.first, propertyValue, key.second);
+    if (!queue.scheduled)
+    {
+        queue.scheduled = true;
+        boost::asio::post(queue.conn->get_io_context(), drainEvents);
+    }
+}
+
+void sendTrailing(EventQueue& queue);
+
+/** @brief Arm the timer for the earliest trailing value that gets a token.
+ */
+void scheduleTrailing(EventQueue& queue)
+{
+    std::optional<EventLimiter::Clock::time_point> deadline;
+    for (const auto& [key, limiter] : queue.limiters)
+    {
+        auto due = limiter.trailingDue();
+        if (due && (!deadline || *due < *deadline))
+        {
+            deadline = due;
+        }
+    }
+    if (!deadline)
+    {
+        return;
+    }
+
+    queue.timer->expires_at(*deadline);
+    queue.timer->async_wait([&queue](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        sendTrailing(queue);
+    });
+}
+
+void sendTrailing(EventQueue& queue)
+{
+    auto now = EventLimiter::Clock::now();
+    for (auto& [key, limiter] : queue.limiters)
+    {
+        auto value = limiter.dueTrailing(now);
+        if (value && queue.events.size() < maxQueuedEvents)
+        {
+            queueEvent(queue, key, limiter, *value);
+        }
+    }
+    scheduleTrailing(queue);
+}
+
+} // namespace
+
+void startRedfishEvents(std::shared_ptr<sdbusplus::asio::connection> conn)
+{
+    auto& queue = eventQueue();
+    queue.timer.emplace(conn->get_io_context());
+    queue.conn = std::move(conn);
+}
+
+void stopRedfishEvents()
+{
+    auto& queue = eventQueue();
+    queue.timer.reset();
+    queue.conn.reset();
+    queue.events.clear();
+    queue.scheduled = false;
+}
+
+const RedfishEventStats& redfishEventStats()
+{
+    return eventQueue().stats;
+}
+
 void parsePropertyValueAndSendEvent(const std::string propertyName,
                                     const std::string dbusPropertyValue,
                                     const std::string objectPath)
@@ -42,14 +223,52 @@ void parsePropertyValueAndSendEvent(const std::string propertyName,
 
 void sendRedfishEvent(const std::string propertyName,
                       const std::string propertyValue,
-                      const std::string objectPath)
-{
-    using namespace phosphor::logging;
-    // send event.
-    std::vector<std::string> messageArgs = {propertyName, propertyValue};
-    auto& conn = AsioConnection::getAsioConnection();
-    sendEvent(conn, MESSAGE_TYPE::PROPERTY_VALUE_MODIFIED,
-              Entry::Level::Informational, messageArgs, objectPath);
+                      const std::string objectPath, bool suppressRepeats)
+{
+    auto& queue = eventQueue();
+    if (!queue.conn)
+    {
+        lg2::error("Redfish events are not started, dropping {PROPERTY}",
+                   "PROPERTY", propertyName);
+        return;
+    }
+
+    auto now = EventLimiter::Clock::now();
+    auto it = queue.limiters
+                  .try_emplace({propertyName, objectPath}, now,
+                               REDFISH_EVENT_BURST, REDFISH_EVENT_RATE)
+                  .first;
+    const auto& key = it->first;
+    auto& limiter = it->second;
+
+    switch (limiter.offer(propertyValue, suppressRepeats, now))
+    {
+        case EventLimiter::Verdict::repeat:
+            queue.stats.duplicates++;
+            return;
+        case EventLimiter::Verdict::limited:
+            if (limiter.limited() == 1)
+            {
+                lg2::info("Rate limiting the Redfish events of {PROPERTY} on "
+                          "{PATH}",
+                          "PROPERTY", propertyName, "PATH", objectPath);
+            }
+            queue.stats.rateLimited++;
+            scheduleTrailing(queue);
+            return;
+        case EventLimiter::Verdict::send:
+            break;
+    }
+    if (queue.events.size() >= maxQueuedEvents)
+    {
+        queue.dropped++;
+        queue.stats.dropped++;
+        limiter.hold(propertyValue);
+        scheduleTrailing(queue);
+        return;
+    }
+
+    queueEvent(queue, key, limiter, propertyValue);
 }
 
 } // namespace bios_config
@@ -0,0 +1,772 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "table_image.hpp"
+
+#include "crc32c.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
+namespace bios_config
+{
+
+namespace
+{
+
+uint64_t align8(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t{7};
+}
+
+template <typename T>
+T readAt(std::string_view bytes, size_t offset)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void writeColumn(std::string& out, uint64_t offset,
+                 const std::vector<T>& column)
+{
+    if (!column.empty())
+    {
+        std::memcpy(out.data() + offset, column.data(),
+                    column.size() * sizeof(T));
+    }
+}
+
+uint32_t checkedU32(size_t value)
+{
+    if (value > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::length_error("BaseBIOSTable too large for the image");
+    }
+    return static_cast<uint32_t>(value);
+}
+
+/** @brief Whether a type read from an image is an AttributeType */
+bool knownType(uint8_t type)
+{
+    using AttributeType = TableImage::AttributeType;
+    switch (static_cast<AttributeType>(type))
+    {
+        case AttributeType::Enumeration:
+        case AttributeType::String:
+        case AttributeType::Password:
+        case AttributeType::Integer:
+        case AttributeType::Boolean:
+            return true;
+    }
+    return false;
+}
+
+/** @brief Whether a bound read from an image is a BoundType */
+bool knownBound(uint32_t bound)
+{
+    using BoundType = TableImage::BoundType;
+    switch (static_cast<BoundType>(bound))
+    {
+        case BoundType::LowerBound:
+        case BoundType::UpperBound:
+        case BoundType::ScalarIncrement:
+        case BoundType::MinStringLength:
+        case BoundType::MaxStringLength:
+        case BoundType::OneOf:
+            return true;
+    }
+    return false;
+}
+
+/** @brief Accumulates the string blob while an image is encoded. Every
+ *         distinct string is stored once, the menu paths and enum labels
+ *         repeat across most attributes of a table.
+ */
+class StringBlob
+{
+  public:
+    StringBlob() = default;
+
+    /** @brief Start from the blob of an image, so the references of its
+     *         rows stay valid. Its strings are not indexed, an added string
+     *         equal to one of them gets a copy.
+     */
+    explicit StringBlob(std::string_view base) : blob(base) {}
+
+    /** @param[in] str - string to add, it must outlive the blob, the index
+     *                   of distinct strings refers to it.
+     */
+    image::StrRef addString(std::string_view str)
+    {
+        auto [it, inserted] = index.try_emplace(str);
+        if (!inserted)
+        {
+            return it->second;
+        }
+        it->second = {checkedU32(blob.size()), checkedU32(str.size())};
+        blob.append(str);
+        return it->second;
+    }
+
+    image::Value addValue(const TableImage::Value& value)
+    {
+        if (const auto* integer = std::get_if<int64_t>(&value))
+        {
+            return {image::Value::integer, 0, static_cast<uint64_t>(*integer)};
+        }
+        auto ref = addString(std::get<std::string>(value));
+        return {image::Value::string, ref.length, ref.offset};
+    }
+
+    const std::string& data() const
+    {
+        return blob;
+    }
+
+  private:
+    std::string blob;
+    std::unordered_map<std::string_view, image::StrRef> index;
+};
+
+} // namespace
+
+image::Layout image::layout(const Header& header)
+{
+    uint64_t n = header.entryCount;
+    uint64_t m = header.optionCount;
+    uint64_t offset = sizeof(Header);
+    auto next = [&offset](uint64_t bytes) {
+        auto start = offset;
+        offset = align8(offset + bytes);
+        return start;
+    };
+
+    Layout layout{};
+    layout.types = next(n);
+    layout.readOnly = next(n);
+    layout.currentValues = next(n * sizeof(Value));
+    layout.defaultValues = next(n * sizeof(Value));
+    layout.firstOption = next((n + 1) * sizeof(uint32_t));
+    layout.bounds = next(m * sizeof(uint32_t));
+    layout.optionValues = next(m * sizeof(Value));
+    layout.names = next(n * sizeof(StrRef));
+    layout.displayNames = next(n * sizeof(StrRef));
+    layout.descriptions = next(n * sizeof(StrRef));
+    layout.menuPaths = next(n * sizeof(StrRef));
+    layout.optionDescriptions = next(m * sizeof(StrRef));
+    layout.strings = offset;
+    layout.size = offset + header.stringsSize;
+    return layout;
+}
+
+template <typename T>
+T TableImage::column(uint64_t offset, size_t i) const
+{
+    return readAt<T>(bytes, offset + i * sizeof(T));
+}
+
+std::string_view TableImage::Attribute::name() const
+{
+    const auto& c = image->columns;
+    return image->string(image->column<image::StrRef>(c.names, id));
+}
+
+TableImage::AttributeType TableImage::Attribute::type() const
+{
+    return static_cast<AttributeType>(
+        image->column<uint8_t>(image->columns.types, id));
+}
+
+bool TableImage::Attribute::readOnly() const
+{
+    return image->column<uint8_t>(image->columns.readOnly, id) != 0;
+}
+
+std::string_view TableImage::Attribute::displayName() const
+{
+    const auto& c = image->columns;
+    return image->string(image->column<image::StrRef>(c.displayNames, id));
+}
+
+std::string_view TableImage::Attribute::description() const
+{
+    const auto& c = image->columns;
+    return image->string(image->column<image::StrRef>(c.descriptions, id));
+}
+
+std::string_view TableImage::Attribute::menuPath() const
+{
+    const auto& c = image->columns;
+    return image->string(image->column<image::StrRef>(c.menuPaths, id));
+}
+
+TableImage::ValueView TableImage::Attribute::currentValue() const
+{
+    const auto& c = image->columns;
+    return image->value(image->column<image::Value>(c.currentValues, id));
+}
+
+TableImage::ValueView TableImage::Attribute::defaultValue() const
+{
+    const auto& c = image->columns;
+    return image->value(image->column<image::Value>(c.defaultValues, id));
+}
+
+std::vector<TableImage::Option> TableImage::Attribute::options() const
+{
+    const auto& c = image->columns;
+    auto first = image->column<uint32_t>(c.firstOption, id);
+    auto end = image->column<uint32_t>(c.firstOption, id + 1);
+
+    std::vector<Option> options;
+    options.reserve(end - first);
+    for (auto i = first; i < end; i++)
+    {
+        options.emplace_back(
+            static_cast<BoundType>(image->column<uint32_t>(c.bounds, i)),
+            image->value(image->column<image::Value>(c.optionValues, i)),
+            image->string(
+                image->column<image::StrRef>(c.optionDescriptions, i)));
+    }
+    return options;
+}
+
+TableImage::BaseTable::mapped_type TableImage::Attribute::decode() const
+{
+    std::vector<std::tuple<BoundType, Value, std::string>> bounds;
+    for (const auto& option : options())
+    {
+        bounds.emplace_back(option.bound, toValue(option.value),
+                            std::string(option.description));
+    }
+    return {type(),
+            readOnly(),
+            std::string(displayName()),
+            std::string(description()),
+            std::string(menuPath()),
+            toValue(currentValue()),
+            toValue(defaultValue()),
+            std::move(bounds)};
+}
+
+TableImage::TableImage(std::string data) :
+    owned(std::move(data)), bytes(owned),
+    head(readAt<image::Header>(bytes, 0)), columns(image::layout(head))
+{}
+
+TableImage::TableImage(void* mapping, size_t length) :
+    mapping(mapping), mappingLength(length),
+    bytes(static_cast<const char*>(mapping), length),
+    head(readAt<image::Header>(bytes, 0)), columns(image::layout(head)),
+    crc(head.crc)
+{}
+
+TableImage::~TableImage()
+{
+    if (mapping != nullptr)
+    {
+        ::munmap(mapping, mappingLength);
+    }
+}
+
+/** @brief Accumulates the columns of an image, row by row, and encodes
+ *         them.
+ */
+class TableImage::Encoder
+{
+  public:
+    /** @param[in] entries - expected number of attributes */
+    explicit Encoder(size_t entries)
+    {
+        reserve(entries);
+    }
+
+    /** @param[in] entries - expected number of attributes
+     *  @param[in] base - blob to append the strings to
+     */
+    Encoder(size_t entries, std::string_view base) : strings(base)
+    {
+        reserve(entries);
+    }
+
+    /** @brief Add an attribute, its strings must outlive the encoder */
+    void add(const std::string& name, const BaseTable::mapped_type& attr)
+    {
+        const auto& [type, attrReadOnly, displayName, description, menuPath,
+                     currentValue, defaultValue, attrBounds] = attr;
+
+        names.push_back(strings.addString(name));
+        types.push_back(static_cast<uint8_t>(type));
+        readOnly.push_back(attrReadOnly ? 1 : 0);
+        displayNames.push_back(strings.addString(displayName));
+        descriptions.push_back(strings.addString(description));
+        menuPaths.push_back(strings.addString(menuPath));
+        currentValues.push_back(strings.addValue(currentValue));
+        defaultValues.push_back(strings.addValue(defaultValue));
+
+        for (const auto& [bound, value, valueDescription] : attrBounds)
+        {
+            bounds.push_back(static_cast<uint32_t>(bound));
+            optionValues.push_back(strings.addValue(value));
+            optionDescriptions.push_back(strings.addString(valueDescription));
+        }
+        firstOption.push_back(checkedU32(bounds.size()));
+    }
+
+    /** @brief Copy the rows of the attributes from first up to end of an
+     *         image whose blob the encoder started from.
+     */
+    void copy(const TableImage& image, size_t first, size_t end)
+    {
+        if (first == end)
+        {
+            return;
+        }
+
+        const auto& c = image.columns;
+        append(types, image, c.types, first, end);
+        append(readOnly, image, c.readOnly, first, end);
+        append(currentValues, image, c.currentValues, first, end);
+        append(defaultValues, image, c.defaultValues, first, end);
+        append(names, image, c.names, first, end);
+        append(displayNames, image, c.displayNames, first, end);
+        append(descriptions, image, c.descriptions, first, end);
+        append(menuPaths, image, c.menuPaths, first, end);
+
+        auto optionsFirst = image.column<uint32_t>(c.firstOption, first);
+        auto optionsEnd = image.column<uint32_t>(c.firstOption, end);
+        auto shift = checkedU32(bounds.size()) - optionsFirst;
+        for (auto i = first + 1; i <= end; i++)
+        {
+            firstOption.push_back(
+                image.column<uint32_t>(c.firstOption, i) + shift);
+        }
+        append(bounds, image, c.bounds, optionsFirst, optionsEnd);
+        append(optionValues, image, c.optionValues, optionsFirst, optionsEnd);
+        append(optionDescriptions, image, c.optionDescriptions, optionsFirst,
+               optionsEnd);
+    }
+
+    size_t blobSize() const
+    {
+        return strings.data().size();
+    }
+
+    /** @brief Encode the image.
+     *
+     *  @param[in] patchedBytes - the patchedBytes field of the header
+     */
+    std::shared_ptr<const TableImage> finish(uint32_t patchedBytes) const
+    {
+        image::Header header{};
+        header.magic = image::magic;
+        header.version = image::version;
+        header.entryCount = checkedU32(names.size());
+        header.optionCount = checkedU32(bounds.size());
+        header.stringsSize = strings.data().size();
+        header.patchedBytes = patchedBytes;
+
+        // The padding between the columns stays zero, so equal tables
+        // built from scratch encode to equal images.
+        auto offsets = image::layout(header);
+        std::string data(offsets.size, '\0');
+        writeColumn(data, offsets.types, types);
+        writeColumn(data, offsets.readOnly, readOnly);
+        writeColumn(data, offsets.currentValues, currentValues);
+        writeColumn(data, offsets.defaultValues, defaultValues);
+        writeColumn(data, offsets.firstOption, firstOption);
+        writeColumn(data, offsets.bounds, bounds);
+        writeColumn(data, offsets.optionValues, optionValues);
+        writeColumn(data, offsets.names, names);
+        writeColumn(data, offsets.displayNames, displayNames);
+        writeColumn(data, offsets.descriptions, descriptions);
+        writeColumn(data, offsets.menuPaths, menuPaths);
+        writeColumn(data, offsets.optionDescriptions, optionDescriptions);
+        data.replace(offsets.strings, strings.data().size(), strings.data());
+
+        // The checksum is left to seal()
+        std::memcpy(data.data(), &header, sizeof(header));
+
+        return std::shared_ptr<const TableImage>(
+            new TableImage(std::move(data)));
+    }
+
+  private:
+    void reserve(size_t entries)
+    {
+        types.reserve(entries);
+        readOnly.reserve(entries);
+        currentValues.reserve(entries);
+        defaultValues.reserve(entries);
+        firstOption.reserve(entries + 1);
+        names.reserve(entries);
+        displayNames.reserve(entries);
+        descriptions.reserve(entries);
+        menuPaths.reserve(entries);
+        firstOption.push_back(0);
+    }
+
+    template <typename T>
+    static void append(std::vector<T>& out, const TableImage& image,
+                       uint64_t offset, size_t first, size_t end)
+    {
+        auto size = out.size();
+        out.resize(size + (end - first));
+        std::memcpy(out.data() + size,
+                    image.bytes.data() + offset + first * sizeof(T),
+                    (end - first) * sizeof(T));
+    }
+
+    StringBlob strings;
+    std::vector<uint8_t> types;
+    std::vector<uint8_t> readOnly;
+    std::vector<image::Value> currentValues;
+    std::vector<image::Value> defaultValues;
+    std::vector<uint32_t> firstOption;
+    std::vector<uint32_t> bounds;
+    std::vector<image::Value> optionValues;
+    std::vector<image::StrRef> names;
+    std::vector<image::StrRef> displayNames;
+    std::vector<image::StrRef> descriptions;
+    std::vector<image::StrRef> menuPaths;
+    std::vector<image::StrRef> optionDescriptions;
+};
+
+std::shared_ptr<const TableImage> TableImage::build(const BaseTable& table)
+{
+    Encoder encoder(table.size());
+    for (const auto& [name, attr] : table)
+    {
+        encoder.add(name, attr);
+    }
+    return encoder.finish(0);
+}
+
+std::shared_ptr<const TableImage> TableImage::open(const fs::path& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(),
+                                "open " + path.string());
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0)
+    {
+        auto err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(),
+                                "fstat " + path.string());
+    }
+
+    auto length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(image::Header))
+    {
+        ::close(fd);
+        throw std::runtime_error(path.string() + " is truncated");
+    }
+
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto err = errno;
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::system_error(err, std::generic_category(),
+                                "mmap " + path.string());
+    }
+
+    std::shared_ptr<const TableImage> table(new TableImage(mapping, length));
+    table->validate();
+    return table;
+}
+
+void TableImage::validate() const
+{
+    auto hdr = header();
+    if (hdr.magic != image::magic || hdr.version != image::version)
+    {
+        throw std::runtime_error("Not a BaseBIOSTable image");
+    }
+
+    if (columns.size != bytes.size())
+    {
+        throw std::runtime_error("BaseBIOSTable image has the wrong size");
+    }
+
+    if (crc32c(bytes.substr(sizeof(hdr))) != hdr.crc)
+    {
+        throw std::runtime_error("BaseBIOSTable image failed the checksum");
+    }
+
+    // The checksum rules out corruption, the offsets and enum values are
+    // still checked so a buggy writer cannot make a lookup read outside of
+    // the image or hand out a type the interface does not define.
+    auto inBlob = [&hdr](uint64_t offset, uint64_t length) {
+        return offset <= hdr.stringsSize && length <= hdr.stringsSize - offset;
+    };
+    auto validRef = [this, &inBlob](uint64_t offset, size_t i) {
+        auto ref = column<image::StrRef>(offset, i);
+        return inBlob(ref.offset, ref.length);
+    };
+    auto validValue = [this, &inBlob](uint64_t offset, size_t i) {
+        auto value = column<image::Value>(offset, i);
+        return value.kind == image::Value::integer ||
+               (value.kind == image::Value::string &&
+                inBlob(value.data, value.length));
+    };
+
+    if (column<uint32_t>(columns.firstOption, 0) != 0 ||
+        column<uint32_t>(columns.firstOption, hdr.entryCount) !=
+            hdr.optionCount)
+    {
+        throw std::runtime_error("BaseBIOSTable image has bad option spans");
+    }
+
+    std::string_view previous;
+    for (size_t i = 0; i < hdr.entryCount; i++)
+    {
+        if (!knownType(column<uint8_t>(columns.types, i)) ||
+            !validRef(columns.names, i) || !validRef(columns.displayNames, i) ||
+            !validRef(columns.descriptions, i) ||
+            !validRef(columns.menuPaths, i) ||
+            !validValue(columns.currentValues, i) ||
+            !validValue(columns.defaultValues, i) ||
+            column<uint32_t>(columns.firstOption, i + 1) <
+                column<uint32_t>(columns.firstOption, i))
+        {
+            throw std::runtime_error("BaseBIOSTable image has a bad entry");
+        }
+
+        auto name = string(column<image::StrRef>(columns.names, i));
+        if (i != 0 && name <= previous)
+        {
+            throw std::runtime_error("BaseBIOSTable image is not sorted");
+        }
+        previous = name;
+    }
+
+    for (size_t i = 0; i < hdr.optionCount; i++)
+    {
+        if (!knownBound(column<uint32_t>(columns.bounds, i)) ||
+            !validRef(columns.optionDescriptions, i) ||
+            !validValue(columns.optionValues, i))
+        {
+            throw std::runtime_error("BaseBIOSTable image has a bad option");
+        }
+    }
+}
+
+size_t TableImage::lowerBound(std::string_view name, size_t first) const
+{
+    size_t low = first;
+    size_t high = size();
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (string(column<image::StrRef>(columns.names, mid)) < name)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+std::optional<TableImage::Attribute>
+    TableImage::find(std::string_view name) const
+{
+    auto id = lowerBound(name, 0);
+    if (id == size() || attribute(id).name() != name)
+    {
+        return std::nullopt;
+    }
+    return Attribute(*this, static_cast<uint32_t>(id));
+}
+
+TableImage::Attribute TableImage::attribute(size_t index) const
+{
+    return Attribute(*this, static_cast<uint32_t>(index));
+}
+
+TableImage::BaseTable TableImage::table() const
+{
+    BaseTable table;
+    for (size_t i = 0; i < size(); i++)
+    {
+        auto attr = attribute(i);
+        table.emplace_hint(table.end(), std::string(attr.name()),
+                           attr.decode());
+    }
+    return table;
+}
+
+std::shared_ptr<const TableImage>
+    TableImage::update(const BaseTable& upserts,
+                       const std::vector<std::string>& removals,
+                       Patch* patch) const
+{
+    std::vector<std::string_view> removed(removals.begin(), removals.end());
+    std::ranges::sort(removed);
+    auto [last, end] = std::ranges::unique(removed);
+    removed.erase(last, end);
+
+    Patch result;
+    auto n = size();
+    Encoder encoder(n + upserts.size(), bytes.substr(columns.strings));
+    result.previous.reserve(n + upserts.size());
+
+    // Walk the changes in name order, the rows between two changed
+    // attributes are copied as they are
+    size_t copied = 0;
+    auto copyUpTo = [&](size_t id) {
+        encoder.copy(*this, copied, id);
+        for (auto i = copied; i < id; i++)
+        {
+            result.previous.push_back(static_cast<uint32_t>(i));
+        }
+        copied = id;
+    };
+    auto upsert = upserts.begin();
+    auto removal = removed.begin();
+    while (upsert != upserts.end() || removal != removed.end())
+    {
+        bool remove = upsert == upserts.end() ||
+                      (removal != removed.end() && *removal <= upsert->first);
+        std::string_view name = remove ? *removal : upsert->first;
+        auto id = lowerBound(name, copied);
+        bool exists = id < n && attribute(id).name() == name;
+        copyUpTo(id);
+        if (remove)
+        {
+            if (upsert != upserts.end() && upsert->first == name)
+            {
+                upsert++;
+            }
+            removal++;
+            if (exists)
+            {
+                result.removed.push_back(static_cast<uint32_t>(id));
+                result.renumbered = true;
+            }
+        }
+        else
+        {
+            result.upserted.push_back(
+                static_cast<uint32_t>(result.previous.size()));
+            result.previous.push_back(exists ? static_cast<uint32_t>(id)
+                                             : noId);
+            result.renumbered = result.renumbered || !exists;
+            encoder.add(upsert->first, upsert->second);
+            upsert++;
+        }
+        copied = exists ? id + 1 : id;
+    }
+    copyUpTo(n);
+
+    auto appended = encoder.blobSize() - header().stringsSize;
+    auto patchedBytes = header().patchedBytes + appended;
+    std::shared_ptr<const TableImage> updated;
+    if (patchedBytes * 2 > encoder.blobSize())
+    {
+        // Mostly strings of replaced attributes, start over
+        updated = build(encoder.finish(0)->table());
+    }
+    else
+    {
+        updated = encoder.finish(checkedU32(patchedBytes));
+    }
+
+    if (patch != nullptr)
+    {
+        *patch = std::move(result);
+    }
+    return updated;
+}
+
+size_t TableImage::size() const
+{
+    return header().entryCount;
+}
+
+void TableImage::seal() const
+{
+    std::call_once(sealed, [this]() {
+        if (mapping != nullptr)
+        {
+            return;
+        }
+        // Only the crc field is written, the other fields and the columns
+        // may be read concurrently
+        crc = crc32c(bytes.substr(sizeof(image::Header)));
+        std::memcpy(owned.data() + offsetof(image::Header, crc), &crc,
+                    sizeof(crc));
+    });
+}
+
+std::string_view TableImage::data() const
+{
+    seal();
+    return bytes;
+}
+
+uint32_t TableImage::checksum() const
+{
+    seal();
+    return crc;
+}
+
+TableImage::Value TableImage::toValue(const ValueView& value)
+{
+    if (const auto* integer = std::get_if<int64_t>(&value))
+    {
+        return *integer;
+    }
+    return std::string(std::get<std::string_view>(value));
+}
+
+std::string_view TableImage::string(const image::StrRef& ref) const
+{
+    return bytes.substr(columns.strings + ref.offset, ref.length);
+}
+
+TableImage::ValueView TableImage::value(const image::Value& value) const
+{
+    if (value.kind == image::Value::integer)
+    {
+        return static_cast<int64_t>(value.data);
+    }
+    return string(image::StrRef{static_cast<uint32_t>(value.data),
+                                value.length});
+}
+
+} // namespace bios_config
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "worker.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/asio/buffer.hpp>
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <system_error>
+
+namespace bios_config
+{
+
+static int createEventFd()
+{
+    int fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+    return fd;
+}
+
+Worker::Worker(boost::asio::io_context& io) :
+    event(io, createEventFd()), thread([this]() { run(); })
+{
+    waitForCompletions();
+}
+
+Worker::~Worker()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void Worker::post(Job job, Completion done)
+{
+    {
+        std::lock_guard lock(mutex);
+        jobs.emplace_back(std::move(job), std::move(done));
+    }
+    wake.notify_one();
+}
+
+void Worker::drain()
+{
+    {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this]() { return jobs.empty() && !busy; });
+    }
+    runCompletions();
+}
+
+void Worker::run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        auto [job, done] = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            job();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        completions.emplace_back(std::move(done), error);
+        busy = false;
+        idle.notify_all();
+
+        uint64_t one = 1;
+        if (::write(event.native_handle(), &one, sizeof(one)) < 0)
+        {
+            lg2::error("Failed to signal the worker completion: {ERRNO}",
+                       "ERRNO", errno);
+        }
+    }
+}
+
+void Worker::waitForCompletions()
+{
+    event.async_read_some(
+        boost::asio::buffer(&eventCount, sizeof(eventCount)),
+        [this](const boost::system::error_code& ec, size_t) {
+        if (ec)
+        {
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                lg2::error("Failed to wait for worker completions: {ERROR}",
+                           "ERROR", ec.message());
+            }
+            return;
+        }
+        runCompletions();
+        waitForCompletions();
+    });
+}
+
+void Worker::runCompletions()
+{
+    std::deque<std::pair<Completion, std::exception_ptr>> ready;
+    {
+        std::lock_guard lock(mutex);
+        ready.swap(completions);
+    }
+
+    for (auto& [done, error] : ready)
+    {
+        done(error);
+    }
+}
+
+} // namespace bios_config
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "attribute_table.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using AttributeType = TableImage::AttributeType;
+using BoundType = TableImage::BoundType;
+using Value = TableImage::Value;
+
+TableImage::BaseTable::mapped_type attribute(const std::string& menuPath)
+{
+    return {AttributeType::Integer,
+            false,
+            "",
+            "",
+            menuPath,
+            Value(0),
+            Value(0),
+            {{BoundType::LowerBound, Value(0), ""},
+             {BoundType::UpperBound, Value(9), ""},
+             {BoundType::ScalarIncrement, Value(1), ""}}};
+}
+
+TableImage::BaseTable makeTable(const std::set<std::string>& names)
+{
+    TableImage::BaseTable table;
+    for (const auto& name : names)
+    {
+        table.emplace(name, attribute("Menu"));
+    }
+    return table;
+}
+
+/** @brief Check every name the table should and should not have */
+void expectIndexed(const AttributeTable& table,
+                   const std::set<std::string>& names,
+                   const std::set<std::string>& missing)
+{
+    ASSERT_EQ(table.image()->size(), names.size());
+    for (const auto& name : names)
+    {
+        auto id = table.find(name);
+        ASSERT_TRUE(id) << name;
+        EXPECT_EQ(table.name(*id), name);
+    }
+    for (const auto& name : missing)
+    {
+        EXPECT_FALSE(table.find(name)) << name;
+    }
+}
+
+/** @brief Names colliding in an index of a given size. A table of 16
+ *         attributes has 32 slots, the home slot of a name is its hash
+ *         masked to that.
+ */
+class Collisions
+{
+  public:
+    explicit Collisions(size_t slots) : mask(slots - 1) {}
+
+    /** @brief The next unused name with a home slot */
+    std::string take(size_t home)
+    {
+        for (;; candidate++)
+        {
+            auto name = "Attr" + std::to_string(candidate);
+            auto hash = std::hash<std::string_view>{}(name);
+            if ((hash & mask) == home)
+            {
+                candidate++;
+                return name;
+            }
+        }
+    }
+
+  private:
+    size_t mask;
+    size_t candidate = 0;
+};
+
+TEST(AttributeIndex, Collisions)
+{
+    Collisions collisions(32);
+    std::set<std::string> names;
+    // A cluster wrapping around the end of the slots, one that runs into
+    // it and names homed in the slots the first one spills into
+    std::vector<std::string> wrapping;
+    for (int i = 0; i < 4; i++)
+    {
+        wrapping.push_back(collisions.take(31));
+    }
+    std::vector<std::string> leading;
+    for (int i = 0; i < 3; i++)
+    {
+        leading.push_back(collisions.take(29));
+    }
+    names.insert(wrapping.begin(), wrapping.end());
+    names.insert(leading.begin(), leading.end());
+    for (size_t home : {0, 1, 2, 2, 7, 7, 7, 12, 20})
+    {
+        names.insert(collisions.take(home));
+    }
+    ASSERT_EQ(names.size(), 16u);
+
+    std::set<std::string> missing;
+    for (size_t home : {31, 29, 0, 2, 7})
+    {
+        missing.insert(collisions.take(home));
+    }
+
+    AttributeTable table(TableImage::build(makeTable(names)), true);
+    expectIndexed(table, names, missing);
+
+    // Erase from the middle and the front of the clusters, the entries
+    // behind them are shifted back and must still be found
+    std::vector<std::string> removals = {wrapping[1], leading[0],
+                                         wrapping[0]};
+    for (const auto& name : removals)
+    {
+        names.erase(name);
+        missing.insert(name);
+    }
+    table.update({}, removals, true);
+    expectIndexed(table, names, missing);
+
+    // Add names into the same clusters again while the slots stay the same
+    TableImage::BaseTable upserts;
+    for (auto name : {collisions.take(31), collisions.take(30),
+                      wrapping[0]})
+    {
+        names.insert(name);
+        missing.erase(name);
+        upserts.emplace(name, attribute("Menu"));
+    }
+    table.update(upserts, {}, true);
+    expectIndexed(table, names, missing);
+
+    // Outgrow the slots
+    upserts.clear();
+    for (int i = 0; i < 4; i++)
+    {
+        auto name = collisions.take(31);
+        names.insert(name);
+        upserts.emplace(name, attribute("Menu"));
+    }
+    table.update(upserts, {}, true);
+    expectIndexed(table, names, missing);
+}
+
+TEST(AttributeIndex, MatchesRebuild)
+{
+    std::mt19937 engine(20260102);
+    std::uniform_int_distribution<int> pick(0, 63);
+    std::set<std::string> names;
+    AttributeTable table(TableImage::build({}), true);
+    for (int round = 0; round < 200; round++)
+    {
+        TableImage::BaseTable upserts;
+        std::vector<std::string> removals;
+        for (int i = 0; i < 6; i++)
+        {
+            auto name = "Attr" + std::to_string(pick(engine));
+            if (pick(engine) % 2 == 0)
+            {
+                upserts.emplace(name, attribute("Menu"));
+            }
+            else
+            {
+                removals.push_back(name);
+            }
+        }
+        table.update(upserts, removals, true);
+        for (const auto& [name, attr] : upserts)
+        {
+            names.insert(name);
+        }
+        // A name that is upserted and removed is removed
+        for (const auto& name : removals)
+        {
+            names.erase(name);
+        }
+
+        std::set<std::string> missing;
+        for (int i = 0; i < 64; i++)
+        {
+            auto name = "Attr" + std::to_string(i);
+            if (!names.contains(name))
+            {
+                missing.insert(name);
+            }
+        }
+        ASSERT_NO_FATAL_FAILURE(expectIndexed(table, names, missing))
+            << "round " << round;
+    }
+}
+
+TEST(MenuTree, EmptyTable)
+{
+    AttributeTable table(TableImage::build({}), true);
+    EXPECT_EQ(table.menus().find(""), nullptr);
+    EXPECT_EQ(table.menus().find("/"), nullptr);
+    EXPECT_EQ(table.menus().find("Boot"), nullptr);
+}
+
+TEST(MenuTree, Find)
+{
+    TableImage::BaseTable base = {
+        {"A", attribute("Boot")},
+        {"B", attribute("/Boot/Advanced/")},
+        {"C", attribute("Security")},
+        {"D", attribute("")},
+    };
+    AttributeTable table(TableImage::build(base), true);
+
+    const auto* root = table.menus().find("");
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(table.menus().find("/"), root);
+    EXPECT_EQ(root->count, 4u);
+    EXPECT_EQ(root->attributes, std::vector<uint32_t>{*table.find("D")});
+
+    const auto* boot = table.menus().find("Boot");
+    ASSERT_NE(boot, nullptr);
+    EXPECT_EQ(boot->count, 2u);
+    EXPECT_EQ(boot->attributes, std::vector<uint32_t>{*table.find("A")});
+    const auto* advanced = table.menus().find("/Boot/./Advanced");
+    ASSERT_NE(advanced, nullptr);
+    EXPECT_EQ(advanced->attributes, std::vector<uint32_t>{*table.find("B")});
+    EXPECT_EQ(table.menus().find("Boot/Missing"), nullptr);
+
+    // Moving the only attribute out of a menu unlinks it
+    table.update({{"B", attribute("Security")}}, {"A"}, true);
+    EXPECT_EQ(table.menus().find("Boot"), nullptr);
+    EXPECT_EQ(table.menus().find("Boot/Advanced"), nullptr);
+    const auto* security = table.menus().find("Security");
+    ASSERT_NE(security, nullptr);
+    EXPECT_EQ(security->attributes,
+              (std::vector<uint32_t>{*table.find("B"), *table.find("C")}));
+
+    // Emptying the table leaves the root without attributes
+    table.update({}, {"B", "C", "D"}, true);
+    EXPECT_EQ(table.menus().find(""), nullptr);
+    EXPECT_EQ(table.menus().find("/"), nullptr);
+    EXPECT_EQ(table.menus().find("Security"), nullptr);
+}
+
+} // namespace
+} // namespace bios_config
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "attribute_validator.hpp"
+
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using AttributeType = TableImage::AttributeType;
+using BoundType = TableImage::BoundType;
+using Value = TableImage::Value;
+using Options = std::vector<std::tuple<BoundType, Value, std::string>>;
+
+// The checks Manager did before the validators, kept verbatim apart from
+// the logging as the reference for the compiled ones.
+
+bool validateEnumOption(const std::string& attrValue, const Options& options)
+{
+    for (const auto& enumOptions : options)
+    {
+        if ((BoundType::OneOf == std::get<0>(enumOptions)) &&
+            (attrValue == std::get<std::string>(std::get<1>(enumOptions))))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool validateStringOption(const std::string& attrValue,
+                          const Options& options)
+{
+    size_t minStringLength = 0;
+    size_t maxStringLength = 0;
+    for (const auto& stringOptions : options)
+    {
+        if (BoundType::MinStringLength == std::get<0>(stringOptions))
+        {
+            minStringLength = std::get<int64_t>(std::get<1>(stringOptions));
+        }
+        else if (BoundType::MaxStringLength == std::get<0>(stringOptions))
+        {
+            maxStringLength = std::get<int64_t>(std::get<1>(stringOptions));
+        }
+    }
+    return attrValue.length() >= minStringLength &&
+           attrValue.length() <= maxStringLength;
+}
+
+bool validateIntegerOption(const int64_t& attrValue, const Options& options)
+{
+    int64_t lowerBound = 0;
+    int64_t upperBound = 0;
+    int64_t scalarIncrement = 0;
+    for (const auto& integerOptions : options)
+    {
+        if (BoundType::LowerBound == std::get<0>(integerOptions))
+        {
+            lowerBound = std::get<int64_t>(std::get<1>(integerOptions));
+        }
+        else if (BoundType::UpperBound == std::get<0>(integerOptions))
+        {
+            upperBound = std::get<int64_t>(std::get<1>(integerOptions));
+        }
+        else if (BoundType::ScalarIncrement == std::get<0>(integerOptions))
+        {
+            scalarIncrement = std::get<int64_t>(std::get<1>(integerOptions));
+        }
+    }
+    if ((attrValue < lowerBound) || (attrValue > upperBound))
+    {
+        return false;
+    }
+    return scalarIncrement != 0 &&
+           ((std::abs(attrValue - lowerBound)) % scalarIncrement) == 0;
+}
+
+/** @brief The old check of a value of the right type */
+bool reference(AttributeType type, const Value& value, const Options& options)
+{
+    switch (type)
+    {
+        case AttributeType::Enumeration:
+            return validateEnumOption(std::get<std::string>(value), options);
+        case AttributeType::String:
+            return validateStringOption(std::get<std::string>(value),
+                                        options);
+        case AttributeType::Integer:
+            return validateIntegerOption(std::get<int64_t>(value), options);
+        default:
+            return true;
+    }
+}
+
+/** @brief Random well-formed tables and values from a fixed seed. Strings
+ *         and numbers are drawn from small ranges so the values hit the
+ *         bounds and the OneOf values often enough.
+ */
+class Generator
+{
+  public:
+    std::string string()
+    {
+        return std::string(pick(0, 5), static_cast<char>('a' + pick(0, 2)));
+    }
+
+    int64_t integer()
+    {
+        return pick(-12, 12);
+    }
+
+    /** @brief A value of the type of the attribute */
+    Value value(AttributeType type)
+    {
+        if (type == AttributeType::Integer)
+        {
+            return integer();
+        }
+        return string();
+    }
+
+    /** @brief Options for an attribute. Options meant for other types are
+     *         mixed in, with values of the type their bound takes, and
+     *         bounds may repeat, be missing or be inverted.
+     */
+    Options options()
+    {
+        Options options;
+        auto count = pick(0, 6);
+        for (int64_t i = 0; i < count; i++)
+        {
+            switch (pick(0, 5))
+            {
+                case 0:
+                    options.emplace_back(BoundType::OneOf, string(), "");
+                    break;
+                case 1:
+                    options.emplace_back(BoundType::MinStringLength,
+                                         pick(0, 5), "");
+                    break;
+                case 2:
+                    options.emplace_back(BoundType::MaxStringLength,
+                                         pick(0, 5), "");
+                    break;
+                case 3:
+                    options.emplace_back(BoundType::LowerBound, integer(),
+                                         "");
+                    break;
+                case 4:
+                    options.emplace_back(BoundType::UpperBound, integer(),
+                                         "");
+                    break;
+                default:
+                    options.emplace_back(BoundType::ScalarIncrement,
+                                         pick(-3, 4), "");
+                    break;
+            }
+        }
+        return options;
+    }
+
+    AttributeType type()
+    {
+        constexpr AttributeType types[] = {AttributeType::Enumeration,
+                                           AttributeType::String,
+                                           AttributeType::Integer};
+        return types[pick(0, 2)];
+    }
+
+  private:
+    int64_t pick(int64_t low, int64_t high)
+    {
+        return std::uniform_int_distribution<int64_t>(low, high)(engine);
+    }
+
+    std::mt19937 engine{20260101};
+};
+
+TableImage::BaseTable::mapped_type attribute(AttributeType type,
+                                             Options options)
+{
+    auto value = type == AttributeType::Integer ? Value(0) : Value("");
+    return {type, false, "", "", "", value, value, std::move(options)};
+}
+
+TEST(AttributeValidator, MatchesOldChecks)
+{
+    Generator generator;
+    TableImage::BaseTable table;
+    for (int i = 0; i < 2000; i++)
+    {
+        table.emplace("Attr" + std::to_string(i),
+                      attribute(generator.type(), generator.options()));
+    }
+    auto image = TableImage::build(table);
+
+    size_t allowed = 0;
+    size_t checked = 0;
+    for (const auto& [name, attr] : table)
+    {
+        auto type = std::get<0>(attr);
+        const auto& options = std::get<7>(attr);
+        auto validator = AttributeValidator::compile(*image->find(name));
+        ASSERT_EQ(validator.type(), type);
+        for (int i = 0; i < 20; i++)
+        {
+            auto value = generator.value(type);
+            auto expected = reference(type, value, options);
+            ASSERT_EQ(validator.validate(value), expected)
+                << name << " value " << testing::PrintToString(value);
+            allowed += expected;
+            checked++;
+        }
+    }
+    // Both outcomes must be covered for the comparison to mean anything
+    EXPECT_GT(allowed, checked / 10);
+    EXPECT_LT(allowed, checked - checked / 10);
+}
+
+TEST(AttributeValidator, WrongValueType)
+{
+    auto image = TableImage::build({
+        {"Enum", attribute(AttributeType::Enumeration,
+                           {{BoundType::OneOf, Value("1"), ""}})},
+        {"Int", attribute(AttributeType::Integer,
+                          {{BoundType::LowerBound, Value(0), ""},
+                           {BoundType::UpperBound, Value(9), ""},
+                           {BoundType::ScalarIncrement, Value(1), ""}})},
+        {"Str", attribute(AttributeType::String,
+                          {{BoundType::MaxStringLength, Value(9), ""}})},
+    });
+
+    auto enumeration = AttributeValidator::compile(*image->find("Enum"));
+    EXPECT_TRUE(enumeration.validate(Value("1")));
+    EXPECT_FALSE(enumeration.validate(Value(1)));
+    auto integer = AttributeValidator::compile(*image->find("Int"));
+    EXPECT_TRUE(integer.validate(Value(1)));
+    EXPECT_FALSE(integer.validate(Value("1")));
+    auto string = AttributeValidator::compile(*image->find("Str"));
+    EXPECT_TRUE(string.validate(Value("1")));
+    EXPECT_FALSE(string.validate(Value(1)));
+}
+
+TEST(AttributeValidator, MalformedOptions)
+{
+    auto image = TableImage::build({
+        {"Enum", attribute(AttributeType::Enumeration,
+                           {{BoundType::OneOf, Value(1), ""}})},
+        {"Int", attribute(AttributeType::Integer,
+                          {{BoundType::UpperBound, Value("9"), ""}})},
+        {"Str", attribute(AttributeType::String,
+                          {{BoundType::MinStringLength, Value(-1), ""}})},
+        // Bounds of other types are not resolved
+        {"Other", attribute(AttributeType::String,
+                            {{BoundType::LowerBound, Value("x"), ""},
+                             {BoundType::MaxStringLength, Value(1), ""}})},
+    });
+
+    for (const auto* name : {"Enum", "Int", "Str"})
+    {
+        EXPECT_THROW(AttributeValidator::compile(*image->find(name)),
+                     std::invalid_argument)
+            << name;
+    }
+    EXPECT_TRUE(
+        AttributeValidator::compile(*image->find("Other")).validate(Value("")));
+
+    auto rejectAll = AttributeValidator::rejectAll(AttributeType::Integer);
+    EXPECT_EQ(rejectAll.type(), AttributeType::Integer);
+    EXPECT_FALSE(rejectAll.validate(Value(0)));
+}
+
+} // namespace
+} // namespace bios_config
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "event_limiter.hpp"
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using namespace std::chrono_literals;
+using Verdict = EventLimiter::Verdict;
+
+class EventLimiterTest : public testing::Test
+{
+  protected:
+    /** @brief Offer a value and send it if the limiter lets it through */
+    Verdict send(const std::string& value, EventLimiter::Clock::duration at,
+                 bool suppressRepeats = true)
+    {
+        auto verdict = limiter.offer(value, suppressRepeats, start + at);
+        if (verdict == Verdict::send)
+        {
+            limiter.sent(value);
+        }
+        return verdict;
+    }
+
+    EventLimiter::Clock::time_point start{1h};
+    // A burst of three and a token every ten seconds
+    EventLimiter limiter{start, 3, 6};
+};
+
+TEST_F(EventLimiterTest, BurstThenLimited)
+{
+    EXPECT_EQ(send("1", 0s), Verdict::send);
+    EXPECT_EQ(send("2", 0s), Verdict::send);
+    EXPECT_EQ(send("3", 0s), Verdict::send);
+    EXPECT_FALSE(limiter.trailingDue());
+
+    EXPECT_EQ(send("4", 1s), Verdict::limited);
+    EXPECT_EQ(send("5", 2s), Verdict::limited);
+    EXPECT_EQ(limiter.limited(), 2u);
+}
+
+TEST_F(EventLimiterTest, TrailingValueIsSentOnRefill)
+{
+    for (auto value : {"1", "2", "3", "4", "5"})
+    {
+        send(value, 0s);
+    }
+
+    // Ten seconds refill one token
+    EXPECT_EQ(limiter.trailingDue(), start + 10s);
+    EXPECT_EQ(limiter.dueTrailing(start + 9s), std::nullopt);
+    EXPECT_EQ(limiter.trailingDue(), start + 10s);
+    auto trailing = limiter.dueTrailing(start + 10s);
+    ASSERT_EQ(trailing, "5");
+    EXPECT_EQ(limiter.sent(*trailing), 2u);
+    EXPECT_EQ(limiter.limited(), 0u);
+    EXPECT_FALSE(limiter.trailingDue());
+    EXPECT_EQ(limiter.dueTrailing(start + 20s), std::nullopt);
+
+    // The token was spent on the trailing value
+    EXPECT_EQ(send("6", 11s), Verdict::limited);
+    EXPECT_EQ(limiter.trailingDue(), start + 20s);
+}
+
+TEST_F(EventLimiterTest, RefillStopsAtBurst)
+{
+    for (auto value : {"1", "2", "3"})
+    {
+        send(value, 0s);
+    }
+
+    // An hour refills the bucket, but only up to the burst
+    EXPECT_EQ(send("4", 1h), Verdict::send);
+    EXPECT_EQ(send("5", 1h), Verdict::send);
+    EXPECT_EQ(send("6", 1h), Verdict::send);
+    EXPECT_EQ(send("7", 1h), Verdict::limited);
+
+    // Half a token is not enough
+    EXPECT_EQ(send("8", 1h + 5s), Verdict::limited);
+    EXPECT_EQ(limiter.trailingDue(), start + 1h + 10s);
+}
+
+TEST_F(EventLimiterTest, Repeats)
+{
+    EXPECT_EQ(send("1", 0s), Verdict::send);
+    EXPECT_EQ(send("1", 0s), Verdict::repeat);
+    EXPECT_EQ(send("1", 0s, false), Verdict::send);
+    EXPECT_EQ(send("2", 0s), Verdict::send);
+    EXPECT_EQ(send("3", 0s), Verdict::limited);
+
+    // Changing back to the value the log shows drops the held back one
+    EXPECT_EQ(send("2", 1s), Verdict::repeat);
+    EXPECT_FALSE(limiter.trailingDue());
+
+    // A held back value that ends up repeating the last one sent is dropped
+    // when it comes due
+    EXPECT_EQ(send("3", 2s), Verdict::limited);
+    limiter.sent("3");
+    EXPECT_EQ(limiter.dueTrailing(start + 1h), std::nullopt);
+    EXPECT_FALSE(limiter.trailingDue());
+}
+
+TEST_F(EventLimiterTest, HeldValueIsDueNow)
+{
+    EXPECT_EQ(limiter.offer("1", true, start + 5s), Verdict::send);
+    // The event queue was full, the value waits without using a token
+    limiter.hold("1");
+    EXPECT_EQ(limiter.trailingDue(), start + 5s);
+    EXPECT_EQ(limiter.dueTrailing(start + 5s), "1");
+    EXPECT_EQ(limiter.sent("1"), 0u);
+}
+
+} // namespace
+} // namespace bios_config
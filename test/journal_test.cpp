@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "journal.hpp"
+
+#include "temp_dir.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using Records = std::vector<std::string>;
+
+class JournalTest : public testing::Test
+{
+  protected:
+    test::TempDir dir;
+    fs::path path = dir.path() / "biosData.journal";
+};
+
+TEST_F(JournalTest, Missing)
+{
+    EXPECT_FALSE(readJournal(path));
+}
+
+TEST_F(JournalTest, AppendAndRead)
+{
+    auto empty = resetJournal(path, 5);
+    EXPECT_EQ(fs::file_size(path), empty);
+
+    appendJournal(path, {"a", "bb"});
+    auto size = appendJournal(path, {"ccc"});
+    EXPECT_EQ(fs::file_size(path), size);
+
+    auto contents = readJournal(path);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->base, 5u);
+    EXPECT_EQ(contents->records, (Records{"a", "bb", "ccc"}));
+    EXPECT_EQ(contents->size, size);
+}
+
+TEST_F(JournalTest, ResetDropsRecords)
+{
+    resetJournal(path, 0);
+    appendJournal(path, {"a", "bb"});
+    resetJournal(path, 2);
+
+    auto contents = readJournal(path);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->base, 2u);
+    EXPECT_TRUE(contents->records.empty());
+}
+
+TEST_F(JournalTest, TornTailIsCutOff)
+{
+    resetJournal(path, 0);
+    auto good = appendJournal(path, {"a", "bb"});
+    auto torn = appendJournal(path, {"ccc"});
+    fs::resize_file(path, torn - 1);
+
+    // Without repair the file is left alone
+    auto contents = readJournal(path, false);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->records, (Records{"a", "bb"}));
+    EXPECT_EQ(contents->size, good);
+    EXPECT_EQ(fs::file_size(path), torn - 1);
+
+    contents = readJournal(path);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->records, (Records{"a", "bb"}));
+    EXPECT_EQ(fs::file_size(path), good);
+
+    // Appends follow the last good record
+    appendJournal(path, {"d"});
+    contents = readJournal(path);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->records, (Records{"a", "bb", "d"}));
+}
+
+TEST_F(JournalTest, CorruptRecordEndsJournal)
+{
+    resetJournal(path, 0);
+    auto good = appendJournal(path, {"a"});
+    appendJournal(path, {"bb", "ccc"});
+
+    // Flip a bit in the payload of the first record after the good part
+    {
+        std::fstream file(path,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(0, std::ios::end);
+        auto end = static_cast<size_t>(file.tellg());
+        ASSERT_GT(end, good);
+        file.seekg(good);
+        std::string tail(end - good, '\0');
+        file.read(tail.data(), tail.size());
+        auto pos = tail.find("bb");
+        ASSERT_NE(pos, std::string::npos);
+        file.seekp(good + pos);
+        file.put('x');
+    }
+
+    auto contents = readJournal(path);
+    ASSERT_TRUE(contents);
+    EXPECT_EQ(contents->records, (Records{"a"}));
+    EXPECT_EQ(fs::file_size(path), good);
+}
+
+TEST_F(JournalTest, UnreadableHeader)
+{
+    resetJournal(path, 0);
+    fs::resize_file(path, 3);
+    EXPECT_FALSE(readJournal(path));
+}
+
+} // namespace
+} // namespace bios_config
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "manager_serialize.hpp"
+#include "table_image.hpp"
+
+#include "temp_dir.hpp"
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using AttributeType = TableImage::AttributeType;
+using BoundType = TableImage::BoundType;
+
+/** @brief A table of integer attributes. The option descriptions are
+ *         empty, version 1 archives do not have them.
+ */
+TableImage::BaseTable makeTable(size_t attributes)
+{
+    TableImage::BaseTable table;
+    for (size_t i = 0; i < attributes; i++)
+    {
+        table.emplace(
+            "Attr" + std::to_string(i),
+            std::make_tuple(AttributeType::Integer, false, "Attribute",
+                            "Description", "Advanced", int64_t(i),
+                            int64_t{0},
+                            std::vector<std::tuple<
+                                BoundType, std::variant<int64_t, std::string>,
+                                std::string>>{
+                                {BoundType::LowerBound, int64_t{0}, ""},
+                                {BoundType::UpperBound, int64_t{100}, ""},
+                                {BoundType::ScalarIncrement, int64_t{1},
+                                 ""}}));
+    }
+    return table;
+}
+
+/** @brief A state that every archive version can hold */
+Snapshot makeState(size_t attributes)
+{
+    Snapshot state;
+    state.baseTable = TableImage::build(makeTable(attributes));
+    if (attributes != 0)
+    {
+        state.pendingAttributes.emplace(
+            "Attr0", std::make_tuple(AttributeType::Integer,
+                                     std::variant<int64_t, std::string>(7)));
+    }
+    state.enableAfterReset = true;
+    // Versions 1 and 2 do not store it and load it as true
+    state.credentialBootstrap = true;
+    state.bootOrder = {"Boot0001", "Boot0002"};
+    state.pendingBootOrder = {"Boot0002", "Boot0001"};
+    state.enable = true;
+    return state;
+}
+
+/** @brief A state to load into, with the defaults of the object */
+Snapshot emptyState()
+{
+    Snapshot state;
+    state.baseTable = TableImage::build({});
+    return state;
+}
+
+void expectLoaded(const Snapshot& loaded, const Snapshot& expected)
+{
+    ASSERT_TRUE(loaded.baseTable);
+    EXPECT_EQ(loaded.baseTable->table(), expected.baseTable->table());
+    EXPECT_EQ(loaded.pendingAttributes, expected.pendingAttributes);
+    EXPECT_EQ(loaded.enableAfterReset, expected.enableAfterReset);
+    EXPECT_EQ(loaded.credentialBootstrap, expected.credentialBootstrap);
+    EXPECT_EQ(loaded.bootOrder, expected.bootOrder);
+    EXPECT_EQ(loaded.pendingBootOrder, expected.pendingBootOrder);
+    EXPECT_EQ(loaded.bootOptions, expected.bootOptions);
+    EXPECT_EQ(loaded.currentBoot, expected.currentBoot);
+    EXPECT_EQ(loaded.enable, expected.enable);
+    EXPECT_EQ(loaded.mode, expected.mode);
+}
+
+/** @brief Write a prepared batch with the sections taken from a state, as
+ *         the writer thread of the service does.
+ */
+void flush(Persistence& persistence, const Snapshot& state)
+{
+    auto batch = persistence.prepare();
+    ASSERT_TRUE(batch);
+    batch->state = state;
+    persistence.write(*batch);
+    persistence.complete(*batch);
+    ASSERT_FALSE(batch->error);
+}
+
+class LegacyTest :
+    public testing::TestWithParam<std::tuple<uint32_t, size_t>>
+{
+  protected:
+    test::TempDir dir;
+    fs::path path = dir.path() / "biosData";
+};
+
+// Version 1 tables of two or three attributes and empty tables of the later
+// versions start with the same bytes, those need a second decode.
+INSTANTIATE_TEST_SUITE_P(
+    Versions, LegacyTest,
+    testing::Combine(testing::Values(1u, 2u, 3u),
+                     testing::Values(size_t{0}, size_t{1}, size_t{2},
+                                     size_t{3}, size_t{40})));
+
+TEST_P(LegacyTest, RoundTrip)
+{
+    auto [version, attributes] = GetParam();
+    auto state = makeState(attributes);
+    saveLegacy(path, state, version);
+
+    Persistence persistence(path);
+    auto loaded = emptyState();
+    ASSERT_TRUE(persistence.load(loaded));
+    expectLoaded(loaded, state);
+
+    // The migration writes the sections and removes the whole-state file
+    EXPECT_TRUE(persistence.pending());
+    flush(persistence, loaded);
+    EXPECT_FALSE(fs::exists(path));
+
+    Persistence reopened(path);
+    auto again = emptyState();
+    ASSERT_TRUE(reopened.load(again));
+    expectLoaded(again, state);
+    EXPECT_FALSE(reopened.pending());
+}
+
+TEST(SaveLegacy, UnknownVersion)
+{
+    test::TempDir dir;
+    EXPECT_THROW(saveLegacy(dir.path() / "biosData", makeState(1), 4),
+                 std::invalid_argument);
+}
+
+class PersistenceTest : public testing::Test
+{
+  protected:
+    /** @brief Start with every section written and an empty journal */
+    void SetUp() override
+    {
+        auto loaded = emptyState();
+        ASSERT_FALSE(persistence.load(loaded));
+        persistence.save(state);
+        ASSERT_FALSE(persistence.pending());
+    }
+
+    Snapshot reload(bool* clean = nullptr)
+    {
+        Persistence reopened(path);
+        auto loaded = emptyState();
+        reopened.load(loaded);
+        if (clean != nullptr)
+        {
+            *clean = reopened.cleanShutdown();
+        }
+        return loaded;
+    }
+
+    test::TempDir dir;
+    fs::path path = dir.path() / "biosData";
+    Persistence persistence{path};
+    Snapshot state = makeState(4);
+};
+
+TEST_F(PersistenceTest, ReplaysRecordsInOrder)
+{
+    using Value = std::variant<int64_t, std::string>;
+    persistence.record(journal::PendingAttribute{
+        "Attr1", {AttributeType::Integer, Value(1)}});
+    persistence.record(journal::PendingAttribute{
+        "Attr1", {AttributeType::Integer, Value(2)}});
+    persistence.record(journal::ClearPendingAttributes{});
+    persistence.record(journal::PendingAttribute{
+        "Attr2", {AttributeType::Integer, Value(3)}});
+    persistence.record(journal::PendingAttribute{
+        "Attr3", {AttributeType::Integer, Value(4)}});
+    persistence.record(journal::DropPendingAttributes{{"Attr3"}});
+    persistence.record(journal::BootOrder{{"Boot0003"}});
+    persistence.record(
+        journal::BootOrderChange{{"Boot0004", "Boot0005"}, {"Boot0005"}});
+    persistence.record(journal::GenerationNumber{Generation::boot, 7});
+    persistence.record(journal::GenerationNumber{Generation::boot, 9});
+    flush(persistence, state);
+
+    auto loaded = reload();
+    EXPECT_EQ(loaded.pendingAttributes,
+              (decltype(loaded.pendingAttributes){
+                  {"Attr2", {AttributeType::Integer, Value(3)}}}));
+    EXPECT_EQ(loaded.bootOrder,
+              (std::vector<std::string>{"Boot0004", "Boot0005"}));
+    EXPECT_EQ(loaded.pendingBootOrder, std::vector<std::string>{"Boot0005"});
+    EXPECT_EQ(loaded.generations[static_cast<size_t>(Generation::boot)], 9u);
+}
+
+TEST_F(PersistenceTest, ReplaysBaseTableDeltas)
+{
+    auto upserts = makeTable(6);
+    upserts.erase("Attr0");
+    persistence.record(journal::BaseTableDelta{upserts, {"Attr1"}});
+    persistence.record(journal::BaseTableDelta{{}, {"Attr2"}});
+    flush(persistence, state);
+
+    auto expected = makeTable(6);
+    expected.erase("Attr1");
+    expected.erase("Attr2");
+    EXPECT_EQ(reload().baseTable->table(), expected);
+}
+
+TEST_F(PersistenceTest, UnchangedSectionIsNotRewritten)
+{
+    auto elided = persistence.elidedWrites();
+    persistence.markDirty(Section::bootOrder);
+    flush(persistence, state);
+    EXPECT_EQ(persistence.elidedWrites(), elided + 1);
+
+    state.bootOrder.emplace_back("Boot0003");
+    persistence.markDirty(Section::bootOrder);
+    flush(persistence, state);
+    EXPECT_EQ(persistence.elidedWrites(), elided + 1);
+    EXPECT_EQ(reload().bootOrder, state.bootOrder);
+}
+
+TEST_F(PersistenceTest, CleanShutdownMarker)
+{
+    bool clean = true;
+    reload(&clean);
+    EXPECT_FALSE(clean);
+
+    persistence.record(journal::BootOrder{{"Boot0003"}});
+    EXPECT_FALSE(persistence.markClean());
+    flush(persistence, state);
+    EXPECT_TRUE(persistence.markClean());
+
+    // Loading removes the marker, the next start is not clean unless it
+    // is marked again
+    reload(&clean);
+    EXPECT_TRUE(clean);
+    reload(&clean);
+    EXPECT_FALSE(clean);
+}
+
+TEST_F(PersistenceTest, WriteAfterMarkRemovesMarker)
+{
+    ASSERT_TRUE(persistence.markClean());
+    persistence.record(journal::BootOrder{{"Boot0003"}});
+    flush(persistence, state);
+
+    bool clean = true;
+    reload(&clean);
+    EXPECT_FALSE(clean);
+}
+
+} // namespace
+} // namespace bios_config
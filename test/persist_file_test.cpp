@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "persist_file.hpp"
+
+#include "temp_dir.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+/** @brief Size of the header in front of every slot payload */
+constexpr size_t slotHeaderSize = 32;
+
+fs::path slotFile(const fs::path& base, const char* suffix)
+{
+    fs::path path = base;
+    path += suffix;
+    return path;
+}
+
+std::string readFile(const fs::path& path)
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    return {std::istreambuf_iterator<char>(is), {}};
+}
+
+void writeFile(const fs::path& path, const std::string& data)
+{
+    std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    os << data;
+}
+
+class PersistFileTest : public testing::Test
+{
+  protected:
+    test::TempDir dir;
+    fs::path base = dir.path() / "section";
+};
+
+TEST_F(PersistFileTest, MissingSlots)
+{
+    EXPECT_TRUE(readSlots(base).empty());
+}
+
+TEST_F(PersistFileTest, NewestSlotFirst)
+{
+    EXPECT_EQ(writeSlot(base, 1, "one"), 1u);
+    EXPECT_EQ(writeSlot(base, 2, "two"), 2u);
+    EXPECT_EQ(writeSlot(base, 3, "three"), 3u);
+
+    auto slots = readSlots(base);
+    ASSERT_EQ(slots.size(), 2u);
+    EXPECT_EQ(slots[0].generation, 3u);
+    EXPECT_EQ(slots[0].format, 3u);
+    EXPECT_EQ(slots[0].payload, "three");
+    EXPECT_EQ(slots[1].generation, 2u);
+    EXPECT_EQ(slots[1].payload, "two");
+}
+
+TEST_F(PersistFileTest, TornPayloadFallsBackToOlderSlot)
+{
+    writeSlot(base, 1, "first payload");
+    writeSlot(base, 1, "second payload");
+
+    // The second write went to the b slot, cut its payload short
+    auto b = slotFile(base, ".b");
+    writeFile(b, readFile(b).substr(0, slotHeaderSize + 3));
+
+    auto slots = readSlots(base);
+    ASSERT_EQ(slots.size(), 1u);
+    EXPECT_EQ(slots[0].generation, 1u);
+    EXPECT_EQ(slots[0].payload, "first payload");
+
+    // The next write still numbers past the torn one, so it wins over it
+    EXPECT_EQ(writeSlot(base, 1, "third payload"), 3u);
+    slots = readSlots(base);
+    ASSERT_FALSE(slots.empty());
+    EXPECT_EQ(slots[0].generation, 3u);
+    EXPECT_EQ(slots[0].payload, "third payload");
+}
+
+TEST_F(PersistFileTest, TornHeaderSlotIsOverwrittenFirst)
+{
+    writeSlot(base, 1, "first payload");
+    writeSlot(base, 1, "second payload");
+
+    auto b = slotFile(base, ".b");
+    writeFile(b, readFile(b).substr(0, slotHeaderSize / 2));
+
+    auto slots = readSlots(base);
+    ASSERT_EQ(slots.size(), 1u);
+    EXPECT_EQ(slots[0].payload, "first payload");
+
+    // Only the a slot is valid, so the torn b slot is replaced and the
+    // valid copy is kept
+    EXPECT_EQ(writeSlot(base, 1, "third payload"), 2u);
+    slots = readSlots(base);
+    ASSERT_EQ(slots.size(), 2u);
+    EXPECT_EQ(slots[0].payload, "third payload");
+    EXPECT_EQ(slots[1].payload, "first payload");
+}
+
+TEST_F(PersistFileTest, CorruptPayloadIsSkipped)
+{
+    writeSlot(base, 1, "first payload");
+    writeSlot(base, 1, "second payload");
+
+    auto b = slotFile(base, ".b");
+    auto data = readFile(b);
+    data.back() ^= 0x01;
+    writeFile(b, data);
+
+    auto slots = readSlots(base);
+    ASSERT_EQ(slots.size(), 1u);
+    EXPECT_EQ(slots[0].payload, "first payload");
+}
+
+TEST_F(PersistFileTest, RemoveFile)
+{
+    auto path = dir.path() / "marker";
+    writeFileAtomic(path, "");
+    EXPECT_TRUE(removeFile(path));
+    EXPECT_FALSE(fs::exists(path));
+    EXPECT_FALSE(removeFile(path));
+}
+
+} // namespace
+} // namespace bios_config
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "crc32c.hpp"
+#include "table_image.hpp"
+
+#include "temp_dir.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace bios_config
+{
+namespace
+{
+
+using AttributeType = TableImage::AttributeType;
+using BoundType = TableImage::BoundType;
+using Value = TableImage::Value;
+
+TableImage::BaseTable makeTable()
+{
+    return {
+        {"BootMode",
+         {AttributeType::Enumeration, false, "Boot Mode", "UEFI or Legacy",
+          "Boot", Value("UEFI"), Value("UEFI"),
+          {{BoundType::OneOf, Value("UEFI"), "UEFI boot"},
+           {BoundType::OneOf, Value("Legacy"), "Legacy boot"}}}},
+        {"Password",
+         {AttributeType::String, true, "Password", "Admin password",
+          "Security", Value(""), Value(""),
+          {{BoundType::MinStringLength, Value(0), ""},
+           {BoundType::MaxStringLength, Value(32), ""}}}},
+        {"Timeout",
+         {AttributeType::Integer, false, "Timeout", "Boot timeout", "Boot",
+          Value(5), Value(5),
+          {{BoundType::LowerBound, Value(0), ""},
+           {BoundType::UpperBound, Value(60), ""},
+           {BoundType::ScalarIncrement, Value(1), ""}}}},
+    };
+}
+
+class TableImageTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        auto table = TableImage::build(makeTable());
+        bytes = std::string(table->data());
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        columns = image::layout(header);
+    }
+
+    /** @brief Write the bytes to a file, sealed with a valid checksum
+     *         unless asked not to, and open it.
+     */
+    std::shared_ptr<const TableImage> open(bool seal = true)
+    {
+        if (seal)
+        {
+            auto crc =
+                crc32c(std::string_view(bytes).substr(sizeof(image::Header)));
+            std::memcpy(bytes.data() + offsetof(image::Header, crc), &crc,
+                        sizeof(crc));
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+        return TableImage::open(path);
+    }
+
+    /** @brief Expect open() to reject the bytes with a message naming the
+     *         reason.
+     */
+    void expectRejected(std::string_view reason, bool seal = true)
+    {
+        try
+        {
+            open(seal);
+            ADD_FAILURE() << "opened an invalid image";
+        }
+        catch (const std::runtime_error& e)
+        {
+            EXPECT_NE(std::string_view(e.what()).find(reason),
+                      std::string_view::npos)
+                << e.what();
+        }
+    }
+
+    template <typename T>
+    void patch(uint64_t offset, size_t i, T value)
+    {
+        std::memcpy(bytes.data() + offset + i * sizeof(T), &value,
+                    sizeof(T));
+    }
+
+    test::TempDir dir;
+    fs::path path = dir.path() / "table";
+    std::string bytes;
+    image::Header header{};
+    image::Layout columns{};
+};
+
+TEST_F(TableImageTest, RoundTrip)
+{
+    auto table = open(false);
+    EXPECT_EQ(table->size(), 3u);
+    EXPECT_EQ(table->table(), makeTable());
+    EXPECT_EQ(table->checksum(), header.crc);
+    EXPECT_TRUE(table->find("Timeout"));
+    EXPECT_FALSE(table->find("Missing"));
+}
+
+TEST_F(TableImageTest, UpdatedImageIsValid)
+{
+    auto table = TableImage::build(makeTable());
+    auto upserts = makeTable();
+    upserts.erase("BootMode");
+    std::get<5>(upserts.at("Timeout")) = Value(10);
+    auto updated = table->update(upserts, {"Password"});
+    bytes = std::string(updated->data());
+
+    auto expected = makeTable();
+    expected.erase("Password");
+    std::get<5>(expected.at("Timeout")) = Value(10);
+    EXPECT_EQ(open(false)->table(), expected);
+}
+
+TEST_F(TableImageTest, Missing)
+{
+    EXPECT_THROW(TableImage::open(path), std::system_error);
+}
+
+TEST_F(TableImageTest, Truncated)
+{
+    bytes.resize(sizeof(image::Header) - 1);
+    expectRejected("truncated", false);
+
+    bytes = std::string(TableImage::build(makeTable())->data());
+    bytes.pop_back();
+    expectRejected("wrong size");
+}
+
+TEST_F(TableImageTest, BadMagic)
+{
+    patch<uint32_t>(offsetof(image::Header, magic), 0, 0);
+    expectRejected("Not a");
+}
+
+TEST_F(TableImageTest, BadChecksum)
+{
+    bytes.back() ^= 1;
+    expectRejected("checksum", false);
+}
+
+TEST_F(TableImageTest, UnknownAttributeType)
+{
+    patch<uint8_t>(columns.types, 1, 0xff);
+    expectRejected("bad entry");
+}
+
+TEST_F(TableImageTest, UnknownBoundType)
+{
+    patch<uint32_t>(columns.bounds, 2, 0xffffffff);
+    expectRejected("bad option");
+}
+
+TEST_F(TableImageTest, StringOutsideBlob)
+{
+    patch(columns.menuPaths, 0,
+          image::StrRef{static_cast<uint32_t>(header.stringsSize), 1});
+    expectRejected("bad entry");
+}
+
+TEST_F(TableImageTest, UnknownValueKind)
+{
+    patch(columns.currentValues, 2, image::Value{7, 0, 0});
+    expectRejected("bad entry");
+}
+
+TEST_F(TableImageTest, BadOptionSpans)
+{
+    patch<uint32_t>(columns.firstOption, 3, header.optionCount + 1);
+    expectRejected("bad option spans");
+}
+
+TEST_F(TableImageTest, Unsorted)
+{
+    image::StrRef first{};
+    image::StrRef second{};
+    std::memcpy(&first, bytes.data() + columns.names, sizeof(first));
+    std::memcpy(&second, bytes.data() + columns.names + sizeof(first),
+                sizeof(second));
+    patch(columns.names, 0, second);
+    patch(columns.names, 1, first);
+    expectRejected("not sorted");
+}
+
+} // namespace
+} // namespace bios_config
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdlib.h>
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace bios_config::test
+{
+
+namespace fs = std::filesystem;
+
+/** @class TempDir
+ *
+ *  @brief A fresh directory for the files of one test, removed with
+ *         everything in it afterwards.
+ */
+class TempDir
+{
+  public:
+    TempDir()
+    {
+        std::string pattern =
+            (fs::temp_directory_path() / "bios-config-test.XXXXXX").string();
+        if (::mkdtemp(pattern.data()) == nullptr)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "mkdtemp");
+        }
+        dir = pattern;
+    }
+
+    ~TempDir()
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const fs::path& path() const
+    {
+        return dir;
+    }
+
+  private:
+    fs::path dir;
+};
+
+} // namespace bios_config::test